@@ -76,19 +76,48 @@ EMSCRIPTEN_BINDINGS() {
     class_<Board>("Board")
         .constructor()
         .function("getBoard", &Board::getBoard)
+        .function("getPieceAt", select_overload<Piece*(int, int, int)>(&Board::getPieceAt), allow_raw_pointers())
         .function("updateLocation", &Board::updateLocation)
         .function("isChecked", &Board::isChecked)
         .function("isCheckmated", &Board::isCheckmated)
         .function("isStalemated", &Board::isStalemated)
         .function("getGameState", &Board::getGameState)
+        .function("getBoardKey", &Board::getBoardKeyHex)
+        .function("getSideToMove", &Board::getSideToMove)
+        .function("getPly", &Board::getPly)
         ;
     class_<Solver>("Solver")
         .constructor<int>()
+        .constructor<int, int>()
         .function("nextMove", &Solver::nextMove)
+        .function("nextMoveWithLimits", &Solver::nextMoveWithLimits)
+        .function("getDefaultLimits", &Solver::getDefaultLimits)
+        .function("getPrincipalVariation", &Solver::getPrincipalVariation)
+        .function("analyze", &Solver::analyze)
+        .function("startPonder", &Solver::startPonder)
+        .function("ponderhit", &Solver::ponderhit)
+        .function("stopPonder", &Solver::stopPonder)
+        .function("setThreads", &Solver::setThreads)
+        .function("getThreads", &Solver::getThreads)
+        .function("getNodes", &Solver::getNodes)
         .function("evaluate", &Solver::evaluate)
         ;
+    value_object<SearchLimits>("SearchLimits")
+        .field("maxTime", &SearchLimits::maxTime)
+        .field("maxNodes", &SearchLimits::maxNodes)
+        .field("maxDepth", &SearchLimits::maxDepth)
+        ;
+    value_object<MemoryStats>("MemoryStats")
+        .field("heapSize", &MemoryStats::heapSize)
+        .field("heapUsed", &MemoryStats::heapUsed)
+        .field("liveBoards", &MemoryStats::liveBoards)
+        .field("livePieces", &MemoryStats::livePieces)
+        ;
+    emscripten::function("getMemoryStats", &getMemoryStats);
     register_vector<Piece*>("vp*");
     register_vector<Move>("vm");
+    register_vector<Turn>("vt");
+    register_vector<vector<Turn>>("vvt");
     register_vector<vector<Piece*>>("vvp*");
     register_vector<vector<vector<Piece*>>>("vvvp*");
 }
@@ -0,0 +1,84 @@
+/* Bitboards. The 125 squares of the board fit in one unsigned 128 bit integer, bit i standing for square i (see Coordinate::toSquare) */
+
+#ifndef bitboard_h
+#define bitboard_h
+
+#include "globals.h"
+#include "geometry.h"
+#include <array>
+
+typedef unsigned __int128 Bitboard;
+static_assert(NUM_SQUARES <= 128, "a Bitboard holds one bit per square");
+
+constexpr Bitboard squareBit(int square) {
+    return Bitboard(1) << square;
+}
+
+// number of squares in the set
+inline int popCount(Bitboard b) {
+    return __builtin_popcountll((unsigned long long)b) + __builtin_popcountll((unsigned long long)(b >> 64));
+}
+
+// lowest square in a non-empty set
+inline int lsb(Bitboard b) {
+    unsigned long long low = (unsigned long long)b;
+    return low ? __builtin_ctzll(low) : 64 + __builtin_ctzll((unsigned long long)(b >> 64));
+}
+
+// removes the lowest square from a non-empty set and returns it
+inline int popLsb(Bitboard& b) {
+    int square = lsb(b);
+    b &= b - 1;
+    return square;
+}
+
+/* Sliding pieces move along 13 line axes: 3 rook axes, 6 bishop axes and 4 unicorn axes (the queen uses all of them).
+* Axis a runs along DIRECTIONS[2 * a] (see geometry.h), whose square index step is positive, so a line is the arithmetic sequence of
+* squares first, first + step, ... and holds at most BOARD_SIZE squares.
+*/
+const int NUM_AXES = 13;
+const int ROOK_AXES = 0;     // axes [0, 3) move along one coordinate
+const int BISHOP_AXES = 3;   // axes [3, 9) move along two coordinates
+const int UNICORN_AXES = 9;  // axes [9, 13) move along all three coordinates
+
+// Where a square sits on the line through it along one axis
+struct LineInfo {
+    unsigned char first;     // lowest square of the line
+    unsigned char start;     // bit offset of the line in the axis' rotated occupancy
+    unsigned char length;    // number of squares on the line
+    unsigned char position;  // index of the square on the line
+};
+
+extern const std::array<std::array<LineInfo, NUM_SQUARES>, NUM_AXES> LINES;
+extern const std::array<std::array<unsigned char, 1 << BOARD_SIZE>, BOARD_SIZE> LINE_ATTACKS; // [position][line occupancy] -> reachable positions
+extern const std::array<std::array<Bitboard, 1 << BOARD_SIZE>, NUM_AXES> LINE_SPREAD;       // [axis][positions] -> squares relative to the line's first square
+
+/* Each axis keeps a "rotated" occupancy in which the squares of every line are consecutive bits, so the occupancy
+* of a line is a shift and a mask. The attack set along the line is then read from LINE_ATTACKS and spread back
+* onto the board with LINE_SPREAD.
+*/
+inline int rotatedIndex(int axis, int square) {
+    return LINES[axis][square].start + LINES[axis][square].position;
+}
+
+inline Bitboard lineAttacks(int axis, int square, Bitboard rotatedOccupancy) {
+    const LineInfo& line = LINES[axis][square];
+    unsigned mask = (1u << line.length) - 1;
+    unsigned occupancy = (unsigned)(rotatedOccupancy >> line.start) & mask;
+    return LINE_SPREAD[axis][LINE_ATTACKS[line.position][occupancy] & mask] << line.first;
+}
+
+// all the squares of the line through square along axis
+inline Bitboard lineSquares(int axis, int square) {
+    const LineInfo& line = LINES[axis][square];
+    return LINE_SPREAD[axis][(1u << line.length) - 1] << line.first;
+}
+
+// Precomputed attack sets of the leaping pieces, for every square
+extern const std::array<Bitboard, NUM_SQUARES> KNIGHT_ATTACKS;
+extern const std::array<Bitboard, NUM_SQUARES> KING_ATTACKS;
+extern const std::array<Bitboard, NUM_SQUARES> PAWN_ATTACKS[2]; // capture squares, indexed by colorIndex()
+extern const std::array<Bitboard, NUM_SQUARES> PAWN_PUSHES[2];  // non-capturing moves, indexed by colorIndex()
+extern const Bitboard PROMOTION_SQUARES[2];                      // squares where pawns promote, indexed by colorIndex()
+
+#endif
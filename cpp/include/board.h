@@ -4,31 +4,126 @@
 #define board_h
 
 #include "piece.h"
+#include "piecetype.h"
+#include "bitboard.h"
+#include "movelist.h"
+#include "zobrist.h"
 #include "coordinate.h"
 #include "move.h"
 #include "globals.h"
+#include <atomic>
 
 class Piece;
 
+const int MAX_PLY = 256; // how many moves makeMove() can stack up before they are unmade
+
+// Everything makeMove() changes that unmakeMove() cannot recompute
+struct UndoInfo {
+    unsigned char from, to;  // squares of the move
+    PieceCode moved;         // the piece that moved, before any promotion
+    PieceCode captured;      // the piece that stood on "to" (EMPTY if none)
+    int quietPlies;          // the board's quietPlies before the move
+};
+
 class Board {
     private:
-        // Vector is used to allow C++ code to be compiled into Webassembly to be run by Javascript
-        vector<vector<vector<Piece*>>> board =
-            vector<vector<vector<Piece*>>>(BOARD_SIZE, vector<vector<Piece*>>(BOARD_SIZE, vector<Piece*>(BOARD_SIZE, NULL)));
+        // The engine's state: one piece code per square, indexed by Coordinate::toSquare()
+        PieceCode squares[NUM_SQUARES];
+
+        // Occupancy sets kept in step with squares[]
+        Bitboard colorPieces[2];        // pieces of each color, indexed by colorIndex()
+        Bitboard typePieces[KING + 1];  // pieces of each type, both colors
+        Bitboard rotated[NUM_AXES];     // occupancy with the squares of each line axis laid out consecutively (see bitboard.h)
+        int kingSquare[2];              // square of each color's king (-1 if it has none), indexed by colorIndex()
+        u_int64_t boardKey;             // Zobrist key of the position (see zobrist.h)
+
+        // Game state
+        int sideToMove;                 // color of the side to move
+        int ply;                        // moves (null moves included) played since the board was set up
+        int quietPlies;                 // moves played since the last capture, pawn move or null move
+        vector<u_int64_t> keyHistory;   // key of the position before each of those moves, oldest first
+        void passTurn();                // hands the move to the other side, once the position left behind is in keyHistory
+
+        // Attack maps, kept in step with squares[] as well
+        Bitboard attacksFrom[NUM_SQUARES]; // squares attacked by the piece on each square
+        Bitboard attackedBy[NUM_SQUARES];  // squares holding a piece (of either color) that attacks each square
+        void setAttacks(int square, Bitboard attacks); // replaces attacksFrom[square], updating attackedBy[]
+
+        void setSquare(int square, PieceCode code); // the only place squares[] is written
+
+        // legal moves of the pieces of color on fromSquares to toSquares (pawns to pawnToSquares instead)
+        void generateLegal(int color, Bitboard fromSquares, Bitboard toSquares, Bitboard pawnToSquares, MoveList& moves) const;
+
+        // Moves made by makeMove() and makeNullMove() that have not been taken back yet, most recent last
+        UndoInfo undoStack[MAX_PLY];
+        int undoCount;
+
+        // Piece objects handed to the javascript frontend. They are only views of squares[],
+        // rebuilt on demand by getPieceAt() and getBoard(), and are owned by the board: each square's view is
+        // constructed in that square's slot of viewStorage, so views never touch the heap and die with the board
+        Piece* views[NUM_SQUARES];
+        alignas(Piece) unsigned char viewStorage[NUM_SQUARES][sizeof(Piece)];
+        Piece* getView(int square);
+
+        static std::atomic<int> liveCount; // number of boards in existence, see getMemoryStats(); search threads copy boards too
 
     public:
-        // Constructor
+        // Constructors
         Board();
+        Board(const Board& other);
+        Board& operator=(const Board& other);
+        ~Board();
+        static int getLiveCount();
 
         // Getters
         Piece* getPieceAt(Coordinate square);
         Piece* getPieceAt(int row, int col, int lvl);
+        PieceCode getPieceCode(Coordinate square);
+        PieceCode getPieceCode(int row, int col, int lvl);
         vector<vector<vector<Piece*>>> getBoard();
+        Coordinate getKingLocation(int color);    // (-1, -1, -1) if color has no king
+        int getKingSquare(int color) const;       // -1 if color has no king
+        Piece* getKing(int color);                // nullptr if color has no king
+        u_int64_t getBoardKey() const;            // Zobrist key of the position, including the side to move
+        string getBoardKeyHex() const;            // the key as 16 hex digits, for javascript (which has no 64 bit integers)
+        int getSideToMove() const;                // WHITE or BLACK
+        int getPly() const;                       // number of moves played so far
+        MoveCode getLastMove() const;             // the move that led to the position (NO_MOVE after a null move, or if unknown)
+        bool isRepetition() const;                // has the position occurred before, with the same side to move?
+        Bitboard getOccupied() const;                   // all occupied squares
+        Bitboard getPieces(int color) const;            // squares holding a piece of color
+        Bitboard getPieces(int color, int type) const;  // squares holding a piece of color and type
+        Bitboard getSliderAttacks(int square, int type) const;      // squares a rook, bishop, unicorn or queen on square attacks
+        Bitboard getAttacks(int square, PieceCode piece) const;     // squares piece would attack from square (pawns: captures only)
+        Bitboard getAttacksFrom(int square) const;                  // squares attacked by the piece on square, from the attack maps
+        Bitboard getAttackers(int square) const;                    // squares whose piece attacks square, from the attack maps
+        Bitboard getMoveTargets(int square, PieceCode piece) const; // squares piece could move to from square, ignoring checks
+        Bitboard getXRayAttacker(int square, int through, Bitboard occupied) const; // the slider attacking square past the (gone) piece on through, if any
+
+        // Setters
+        void setPieceCode(Coordinate square, PieceCode code);
+        void setSideToMove(int color);
 
+        // Move generation. The generators append to a MoveList; pseudo-legal moves may leave the mover's king in check
+        void generateMovesFrom(int square, MoveList& moves) const;      // pseudo-legal moves of the piece on square
+        void generateMoves(int color, MoveList& moves) const;           // pseudo-legal moves of every piece of color
+        void generateLegalMovesFrom(int square, MoveList& moves) const; // legal moves of the piece on square
+        void generateLegalMoves(int color, MoveList& moves) const;      // legal moves of every piece of color
+        void generateLegalCaptures(int color, MoveList& moves) const;   // legal moves of color that take a piece or promote
+        void generateLegalQuiets(int color, MoveList& moves) const;     // legal moves of color that do neither
+        bool isLegalMove(MoveCode move) const; // can the side to move play move? (for moves from elsewhere, like the transposition table)
+        vector<Move> getMovesAt(Coordinate square, bool prune); // returns all moves of the piece at square. if pruning is enabled, return all possible legal moves
         void updateLocation(Coordinate square, Move movement); // moves piece from coordinate square to new square on the board
-        bool isChecked(int pieceColor); // is king of color "pieceColor" checked?
-        bool isCheckmated(int pieceColor); // is king of color "pieceColor" checkmated? (only run this is isChecked() == true)
-        bool isStalemated(int pieceColor); // is side of color "pieceColor" stalemated?
+        void makeMove(int from, int to, int promotion = EMPTY); // plays a (pseudo-legal) move, promoting to "promotion" if given
+        void makeMove(MoveCode move); // plays a move from the generators above
+        void makeMove(Coordinate square, Move movement, int promotion = EMPTY);
+        void unmakeMove(); // takes back the last move played by makeMove()
+        void makeNullMove(); // passes the turn without moving
+        void unmakeNullMove(); // takes back the last makeNullMove()
+        bool isSquareAttacked(int square, int byColor) const; // does any piece of color "byColor" attack square?
+        bool isChecked(int pieceColor) const; // is king of color "pieceColor" checked?
+        bool isCheckmated(int pieceColor) const; // is king of color "pieceColor" checkmated? (only run this is isChecked() == true)
+        bool isStalemated(int pieceColor) const; // is side of color "pieceColor" stalemated?
         string getGameState(int turnPlayer); // returns the state of the game in a string
         /*
         * Possible Game States:
@@ -47,8 +142,7 @@ class Board {
 
         // Friend classes; allow them to directly modify the private board
         friend class Solver;
-        friend class Piece;
-        friend class Pawn;
+        friend class MovePicker;
 };
 
 #endif
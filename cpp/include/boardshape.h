@@ -0,0 +1,76 @@
+/* BoardShape template. The compile-time layout of a board of Dims axes with Extent squares each: square numbering,
+* bounds checks and steps, shared by every table built over the board.
+*
+* Only the layout is generic. Board, the geometry tables, move generation and Solver are written for Raumschach
+* below, and the engine is not instantiated for the site's other modes: that needs a Bitboard wider than 128 squares
+* (the 4D board has 625) and each mode's own pieces and rules, and is left for later */
+
+#ifndef boardshape_h
+#define boardshape_h
+
+#include <array>
+
+template <int Extent, int Dims>
+struct BoardShape {
+    static_assert(Extent > 0 && Dims > 0, "a board needs at least one square");
+
+    typedef std::array<int, Dims> Point; // one coordinate (or step) per axis
+
+    static constexpr int EXTENT = Extent;
+    static constexpr int DIMS = Dims;
+
+    // base to the power n
+    static constexpr int power(int base, int n) {
+        return n == 0 ? 1 : base * power(base, n - 1);
+    }
+
+    static constexpr int NUM_SQUARES = power(Extent, Dims);
+    static constexpr int NUM_DIRECTIONS = power(3, Dims) - 1; // every step of -1, 0 or +1 per axis, except standing still
+
+    // Squares are numbered with the first axis varying slowest, so one step along axis moves stride(axis) squares
+    static constexpr int stride(int axis) {
+        return power(Extent, Dims - 1 - axis);
+    }
+
+    static constexpr int coordinate(int square, int axis) {
+        return square / stride(axis) % Extent;
+    }
+
+    static constexpr int toSquare(const Point& point) {
+        int square = 0;
+        for (int axis = 0; axis < Dims; ++axis) square = square * Extent + point[axis];
+        return square;
+    }
+
+    static constexpr Point fromSquare(int square) {
+        Point point{};
+        for (int axis = 0; axis < Dims; ++axis) point[axis] = coordinate(square, axis);
+        return point;
+    }
+
+    static constexpr bool contains(const Point& point) {
+        for (int axis = 0; axis < Dims; ++axis) {
+            if (point[axis] < 0 || point[axis] >= Extent) return false;
+        }
+        return true;
+    }
+
+    // difference in square number made by a step (only meaningful if the step stays on the board)
+    static constexpr int offset(const Point& delta) {
+        int total = 0;
+        for (int axis = 0; axis < Dims; ++axis) total += delta[axis] * stride(axis);
+        return total;
+    }
+
+    // square reached from square by step, or -1 off the board
+    static constexpr int step(int square, const Point& delta) {
+        Point point = fromSquare(square);
+        for (int axis = 0; axis < Dims; ++axis) point[axis] += delta[axis];
+        return contains(point) ? toSquare(point) : -1;
+    }
+};
+
+// The board the engine plays on: Raumschach's 5 rows, 5 columns and 5 levels
+typedef BoardShape<5, 3> Raumschach;
+
+#endif
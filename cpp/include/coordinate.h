@@ -19,8 +19,13 @@ class Coordinate {
 
         string toString();
 
+        // Conversion to and from the flat square index used by the board
+        int toSquare();
+        static Coordinate fromSquare(int square);
+
         // Operator overloads for easy Coordinate arithmetic
-        Coordinate operator+(const Move&);
+        Coordinate operator+(const Move&) const;
+        Move operator-(const Coordinate&) const; // the Move taking the other coordinate to this one
         Coordinate& operator+=(const Move&);
         Coordinate& operator=(const Coordinate&);
 };
@@ -0,0 +1,98 @@
+/* Board geometry. Direction sets of every piece and, for every square, the rays and neighbours already clipped to the board */
+
+#ifndef geometry_h
+#define geometry_h
+
+#include "globals.h"
+#include <array>
+
+// A step of (row, col, lvl)
+struct Direction {
+    int row, col, lvl;
+};
+
+/* The 26 directions of the queen and king. Directions 2 * axis and 2 * axis + 1 are the positive and negative
+* steps along line axis "axis" (see bitboard.h), so the opposite of direction d is d ^ 1 and the rook, bishop
+* and unicorn directions are the ranges below.
+*/
+const int NUM_DIRECTIONS = 26;
+const int ROOK_DIRECTIONS = 0;     // directions [0, 6) move along one coordinate
+const int BISHOP_DIRECTIONS = 6;   // directions [6, 18) move along two coordinates
+const int UNICORN_DIRECTIONS = 18; // directions [18, 26) move along all three coordinates
+
+constexpr Direction DIRECTIONS[NUM_DIRECTIONS] = {
+    {0, 0, 1}, {0, 0, -1}, {0, 1, 0}, {0, -1, 0}, {1, 0, 0}, {-1, 0, 0},
+    {0, 1, 1}, {0, -1, -1}, {0, 1, -1}, {0, -1, 1}, {1, 0, 1}, {-1, 0, -1},
+    {1, 0, -1}, {-1, 0, 1}, {1, 1, 0}, {-1, -1, 0}, {1, -1, 0}, {-1, 1, 0},
+    {1, 1, 1}, {-1, -1, -1}, {1, 1, -1}, {-1, -1, 1}, {1, -1, 1}, {-1, 1, -1}, {1, -1, -1}, {-1, 1, 1}
+};
+static_assert(NUM_DIRECTIONS == Raumschach::NUM_DIRECTIONS, "every step to a neighbouring square is a direction");
+
+// the knight moves 2 squares along one axis and 1 along another
+const int NUM_KNIGHT_JUMPS = 24;
+constexpr Direction KNIGHT_JUMPS[NUM_KNIGHT_JUMPS] = {
+    {2, 1, 0}, {2, -1, 0}, {-2, 1, 0}, {-2, -1, 0}, {1, 2, 0}, {1, -2, 0}, {-1, 2, 0}, {-1, -2, 0},
+    {2, 0, 1}, {2, 0, -1}, {-2, 0, 1}, {-2, 0, -1}, {1, 0, 2}, {1, 0, -2}, {-1, 0, 2}, {-1, 0, -2},
+    {0, 2, 1}, {0, 2, -1}, {0, -2, 1}, {0, -2, -1}, {0, 1, 2}, {0, 1, -2}, {0, -1, 2}, {0, -1, -2}
+};
+
+// pawns move one row forward or one level up (down for black), indexed by colorIndex()
+constexpr Direction PAWN_PUSH_STEPS[2][2] = {
+    {{1, 0, 0}, {0, 0, 1}},
+    {{-1, 0, 0}, {0, 0, -1}}
+};
+
+// pawns capture one column sideways while moving forward, either on their level or one level up (down for black)
+constexpr Direction PAWN_CAPTURE_STEPS[2][4] = {
+    {{1, 1, 0}, {1, -1, 0}, {1, 1, 1}, {1, -1, 1}},
+    {{-1, 1, 0}, {-1, -1, 0}, {-1, 1, -1}, {-1, -1, -1}}
+};
+
+// pawns promote on the last row of the top level (the first row of the bottom level for black)
+constexpr bool isPromotionSquare(int color, int square) {
+    return Raumschach::coordinate(square, 0) + Raumschach::coordinate(square, 2) == (color > 0 ? 2 * (BOARD_SIZE - 1) : 0);
+}
+
+constexpr bool isOnBoard(int row, int col, int lvl) {
+    return Raumschach::contains({row, col, lvl});
+}
+
+// square reached from square by one step in direction d, or -1 off the board
+constexpr int stepSquare(int square, Direction d) {
+    return Raumschach::step(square, {d.row, d.col, d.lvl});
+}
+
+// direction d in which square "to" lies from square "from" along a line (see RAYS), or -1 if they share no line
+constexpr int directionBetween(int from, int to) {
+    int step[3] = {0, 0, 0};
+    int distance = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        int diff = Raumschach::coordinate(to, axis) - Raumschach::coordinate(from, axis);
+        if (diff == 0) continue;
+        int size = diff < 0 ? -diff : diff;
+        if (distance != 0 && size != distance) return -1; // not a straight line
+        distance = size;
+        step[axis] = diff < 0 ? -1 : 1;
+    }
+    for (int d = 0; d < NUM_DIRECTIONS && distance != 0; ++d) {
+        if (DIRECTIONS[d].row == step[0] && DIRECTIONS[d].col == step[1] && DIRECTIONS[d].lvl == step[2]) return d;
+    }
+    return -1;
+}
+
+// The squares met when sliding from a square in one direction, nearest first
+struct Ray {
+    unsigned char length;
+    unsigned char squares[BOARD_SIZE - 1];
+};
+
+// The squares around a square
+struct Neighbours {
+    unsigned char count;
+    unsigned char squares[NUM_DIRECTIONS];
+};
+
+extern const std::array<std::array<Ray, NUM_DIRECTIONS>, NUM_SQUARES> RAYS;    // [square][direction]
+extern const std::array<Neighbours, NUM_SQUARES> NEIGHBOURS;                   // all 26 directions
+
+#endif
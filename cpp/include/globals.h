@@ -10,10 +10,14 @@
 #include <random>
 #include <unordered_map>
 #include <iostream> // For debugging
+#include "boardshape.h"
 using namespace std;
 
 extern int BLACK;
 extern int WHITE;
-extern int BOARD_SIZE;
+
+// Board dimensions. Squares are stored flat, indexed by (row * BOARD_SIZE + col) * BOARD_SIZE + lvl (see boardshape.h)
+const int BOARD_SIZE = Raumschach::EXTENT;
+const int NUM_SQUARES = Raumschach::NUM_SQUARES;
 
 #endif
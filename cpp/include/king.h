@@ -13,7 +13,7 @@ class King: public Piece {
     public:
         char getId(); // returns ID identifying the piece
         using Piece::Piece; // use constructor of parent class
-        vector<Move> getMoves(Board board, bool prune); // returns all possible moves of the piece. if pruning is enabled, return all possible legal moves
+        vector<Move> getMoves(Board& board, bool prune); // returns all possible moves of the piece. if pruning is enabled, return all possible legal moves
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,17 @@
+/* Memory accounting, so the frontend can watch heap use and object counts over a long session */
+
+#ifndef memorystats_h
+#define memorystats_h
+
+#include "globals.h"
+
+struct MemoryStats {
+    int heapSize;    // bytes the allocator has obtained from the system (the wasm heap in use)
+    int heapUsed;    // bytes currently allocated
+    int liveBoards;  // Board objects in existence
+    int livePieces;  // Piece objects in existence, board views included
+};
+
+MemoryStats getMemoryStats();
+
+#endif
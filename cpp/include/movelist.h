@@ -0,0 +1,82 @@
+/* Engine moves. A move is packed in 16 bits, and the move generators append them to a fixed-capacity MoveList */
+
+#ifndef movelist_h
+#define movelist_h
+
+#include "globals.h"
+#include "piecetype.h"
+#include <functional>
+
+/* MoveCode layout: bits 0-6 hold the square the piece leaves, bits 7-13 the square it lands on (see
+* Coordinate::toSquare) and bit 14 is set when a pawn promotes, always to a queen: the generators emit no
+* underpromotions, so the encoding holds none.
+*/
+typedef unsigned short MoveCode;
+
+const MoveCode NO_MOVE = 0; // from square 0 to square 0 is never a move
+
+inline MoveCode makeMoveCode(int from, int to, int promotion = EMPTY) {
+    assert(promotion == EMPTY || promotion == QUEEN);
+    return MoveCode(from | (to << 7) | ((promotion == QUEEN) << 14));
+}
+
+inline int moveFrom(MoveCode move) {
+    return move & 0x7F;
+}
+
+inline int moveTo(MoveCode move) {
+    return (move >> 7) & 0x7F;
+}
+
+// the type the move promotes to (EMPTY if it does not promote)
+inline int movePromotion(MoveCode move) {
+    return move >> 14 ? QUEEN : EMPTY;
+}
+
+// A side has at most 20 pieces. Even with all ten pawns promoted to queens, its 11 queens (52 squares at most, in
+// the centre), bishops and knights (24), unicorns (16), rooks (12) and king (26) make no more than 750 moves; a pawn
+// has at most 6
+const int MAX_MOVES = 1024;
+
+// Moves with an ordering score each, kept in a parallel array
+class MoveList {
+    private:
+        MoveCode moves[MAX_MOVES];
+        int scores[MAX_MOVES];
+        int count = 0;
+    public:
+        void add(MoveCode move) {
+            assert(count < MAX_MOVES);
+            moves[count++] = move;
+        }
+        void removeAt(int i) { // the last move takes the place of the removed one
+            moves[i] = moves[--count];
+            scores[i] = scores[count];
+        }
+        void clear() { count = 0; }
+        void swap(int i, int j) {
+            std::swap(moves[i], moves[j]);
+            std::swap(scores[i], scores[j]);
+        }
+
+        int size() const { return count; }
+        bool empty() const { return count == 0; }
+        MoveCode operator[](int i) const { return moves[i]; }
+        const MoveCode* begin() const { return moves; }
+        const MoveCode* end() const { return moves + count; }
+
+        int getScore(int i) const { return scores[i]; }
+        void setScore(int i, int score) { scores[i] = score; }
+        void sortByScore() { // highest score first
+            // sort each score together with its move by packing both in one integer
+            long long keyed[MAX_MOVES];
+            for (int i = 0; i < count; ++i) keyed[i] = (long long)scores[i] * 65536 + moves[i];
+            sort(keyed, keyed + count, greater<long long>());
+            for (int i = 0; i < count; ++i) {
+                moves[i] = MoveCode(keyed[i] & 0xFFFF);
+                scores[i] = int((keyed[i] - moves[i]) / 65536);
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,63 @@
+/* MovePicker class. Hands the search the moves of a position one at a time, best first, generating each group of
+* moves only once the moves before it are used up */
+
+#ifndef movepicker_h
+#define movepicker_h
+
+#include "board.h"
+#include "movelist.h"
+#include "globals.h"
+
+class Solver;
+
+/* The order of the stages. Most nodes cut off on the first move or two, and never pay for generating (and
+* legality-checking) the quiet moves:
+*
+* TT_MOVE           the best move the transposition table remembers
+* GOOD_CAPTURES     captures and promotions by MVV/LVA, except those losing material (by static exchange evaluation)
+* KILLERS           the two killer moves of the ply, then the countermove
+* QUIETS            the other quiet moves, by history
+* BAD_CAPTURES      the captures put aside as losing
+*
+* In quiescence search only the good captures are picked, in MVV/LVA order; the losing ones are left out.
+* Killers and countermoves are quiet moves (no promotions), so each move is picked at most once.
+*/
+enum PickerStage {
+    TT_MOVE,
+    GENERATE_CAPTURES,
+    GOOD_CAPTURES,
+    KILLERS,
+    GENERATE_QUIETS,
+    QUIETS,
+    BAD_CAPTURES,
+    QUIESCENCE_CAPTURES,
+    DONE
+};
+
+class MovePicker {
+    private:
+        Solver &solver;
+        Board &board;
+        MoveList &moves;        // captures at the front, then quiets; losing captures put aside are moved to the very front
+        int stage;
+        MoveCode ttMove;
+        MoveCode refutations[3]; // the killers and the countermove
+        int refutationIndex;
+        int current;            // next move of the stage's range to look at
+        int badCaptures;        // number of captures put aside
+        int quietsStart;        // where the quiets start in moves
+
+        void scoreCaptures();
+        int pickBest(int end); // moves the best scored move of [current, end) to current and returns its index
+        bool isRefutation(MoveCode move) const;
+        bool isLosing(MoveCode move) const;
+
+    public:
+        // moves is working space, which must not be used by anything else until the picker is done
+        MovePicker(Solver &solver, Board &board, MoveList &moves, MoveCode ttMove, int ply);
+        MovePicker(Solver &solver, Board &board, MoveList &moves); // good captures only, for quiescence search
+
+        MoveCode next(); // NO_MOVE once every move was picked
+};
+
+#endif
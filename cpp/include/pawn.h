@@ -13,8 +13,8 @@ class Pawn: public Piece {
     public:
         char getId(); // returns ID identifying the piece
         using Piece::Piece; // use constructor of parent class
-        vector<Move> getMoves(Board board, bool prune); // returns all possible moves of the piece. if pruning is enabled, return all possible legal moves
-        void promote(Board& board, Piece* promotedPiece, bool deletePiece); // handles pawn promotion
+        vector<Move> getMoves(Board& board, bool prune); // returns all possible moves of the piece. if pruning is enabled, return all possible legal moves
+        void promote(Board& board, Piece* promotedPiece, bool deletePiece); // handles pawn promotion. deletePiece hands ownership of promotedPiece to the board
 };
 
 #endif
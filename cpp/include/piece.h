@@ -7,6 +7,8 @@
 #include "move.h"
 #include "globals.h"
 
+#include <atomic>
+
 class Board;
 
 class Piece {
@@ -14,11 +16,14 @@ class Piece {
         bool isAlive = true;    // is the piece alive / caputred?
         Coordinate location;    // the 3D coordinate of the piece on board
         int color;              // color of the piece (black or white)
+        static std::atomic<int> liveCount; // threads of the search may create and destroy pieces at the same time
     public:
         // Constructors
         Piece();
         Piece(int row, int col, int lvl, int color);
-        //virtual ~Piece() = 0;
+        Piece(const Piece& other);
+        virtual ~Piece();
+        static int getLiveCount(); // number of piece objects in existence (board views and javascript-created pieces)
 
         // Getters
         bool getIsAlive();
@@ -31,13 +36,10 @@ class Piece {
         void setColor(int color);
 
         string toString();
-        vector<Move> getAllMovesInLine(vector<Move>, Board, bool);  // bool is to specify if we want to prune for checks
-        vector<Move> pruneMoves(vector<Move>, Board, Coordinate);
-        bool hasAnyMoves(Board, Coordinate);    // Checks if a piece has any legal moves
 
-        //virtual vector<Move> getMoves(Board, bool) = 0; // Pure virtual function. Each piece has unique set of moves
+        //virtual vector<Move> getMoves(Board&, bool) = 0; // Pure virtual function. Each piece has unique set of moves
         //virtual char getId() = 0;
-        virtual vector<Move> getMoves(Board, bool);
+        virtual vector<Move> getMoves(Board&, bool); // the piece's moves, which the board generates from its attack tables for every subclass
         virtual char getId();
         /* NOTE that we would have used pure virtual functions, and made Piece an abstract base class.
         * However emscripten (the program that compiles our C++ code) into webassembly such that it can
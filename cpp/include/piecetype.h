@@ -0,0 +1,44 @@
+/* Piece type codes. The board stores one signed byte per square: the piece type multiplied by the piece's color */
+
+#ifndef piecetype_h
+#define piecetype_h
+
+#include "globals.h"
+
+typedef signed char PieceCode;
+
+enum PieceType {
+    EMPTY = 0,
+    PAWN,
+    KNIGHT,
+    BISHOP,
+    UNICORN,
+    ROOK,
+    QUEEN,
+    KING
+};
+
+// Builds the code stored on the board for a piece of the given type and color
+inline PieceCode makePieceCode(int type, int color) {
+    return PieceCode(type * color);
+}
+
+// Type of the piece encoded by code (EMPTY for a vacant square)
+inline int pieceTypeOf(PieceCode code) {
+    return code < 0 ? -code : code;
+}
+
+// Color of the piece encoded by code (0 for a vacant square, like the Empty piece)
+inline int pieceColorOf(PieceCode code) {
+    return code > 0 ? WHITE : (code < 0 ? BLACK : 0);
+}
+
+// Index of a color in per-color tables: 0 for white, 1 for black
+inline int colorIndex(int color) {
+    return color == WHITE ? 0 : 1;
+}
+
+char pieceId(int type);         // returns the ID used by the Piece classes for a piece type (' ' for EMPTY)
+int pieceTypeFromId(char id);   // inverse of pieceId()
+
+#endif
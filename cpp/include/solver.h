@@ -9,11 +9,63 @@
 #include "piece.h"
 #include "pawn.h"
 #include "queen.h"
+#include "transposition.h"
+#include "movepicker.h"
 #include "globals.h"
 #include <chrono>
-#include <unordered_map>
 #include <vector>
 #include <random>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+// Helper search threads need pthreads, which a webassembly build only has when compiled with -pthread
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define HAS_SEARCH_THREADS 0
+#else
+#define HAS_SEARCH_THREADS 1
+#endif
+
+// Threads of a webassembly build must come from the workers made when the module loads (emcc -pthread
+// -sPTHREAD_POOL_SIZE=4). One beyond the pool only starts once the browser's main thread goes back to its event loop,
+// which it never does while it waits to join that thread. A search runs setThreads() - 1 helpers, plus the ponder
+// thread, so setThreads() is capped at SEARCH_THREAD_POOL, which must match PTHREAD_POOL_SIZE
+#if defined(__EMSCRIPTEN_PTHREADS__) && !defined(SEARCH_THREAD_POOL)
+#define SEARCH_THREAD_POOL 4
+#endif
+
+// Weight of each piece type (higher = more important), indexed by PieceType
+constexpr int PIECE_VALUES[KING + 1] = {0, 100, 400, 400, 400, 500, 900, 10000};
+
+// Capture ordering score, [victim type][attacker type]: most valuable victim first, then least valuable attacker.
+// Every capture scores above zero and non-captures score zero
+constexpr std::array<std::array<int, KING + 1>, KING + 1> buildMvvLva() {
+    std::array<std::array<int, KING + 1>, KING + 1> table{};
+    for (int victim = PAWN; victim <= KING; ++victim) {
+        for (int attacker = PAWN; attacker <= KING; ++attacker) {
+            table[victim][attacker] = PIECE_VALUES[victim] * 10 - PIECE_VALUES[attacker] / 100;
+        }
+    }
+    return table;
+}
+constexpr std::array<std::array<int, KING + 1>, KING + 1> MVV_LVA = buildMvvLva();
+
+// Bonus for occupying each square, [row][col][lvl]
+constexpr int PIECE_SQUARE_TABLE[BOARD_SIZE][BOARD_SIZE][BOARD_SIZE] = {
+    {{0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}},
+    {{5,  5,  5,  5,  5}, {5,  5,  5,  5,  5}, {5,  5,  5,  5,  5}, {5,  5,  5,  5,  5}, {5,  5,  5,  5,  5}},
+    {{1,  1,  2,  1,  1}, {1,  1,  2,  1,  1}, {1,  1,  2,  1,  1}, {1,  1,  2,  1,  1}, {1,  1,  2,  1,  1}},
+    {{0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}},
+    {{0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}}
+};
+
+// Limits of one nextMove() call. A limit of 0 (or less) means none; the depth is capped by the search's ply limit
+struct SearchLimits {
+    int maxTime;      // milliseconds
+    double maxNodes;  // positions searched by the main thread (a double for javascript)
+    int maxDepth;     // plies of iterative deepening
+};
 
 class Solver {
 private:
@@ -30,45 +82,159 @@ private:
 
     // Search Parameters (Tune these!)
     static const int MAX_QUIESCENCE_DEPTH = 3;
-    static const int ASPIRATION_WINDOW = 50;
+    static const int DELTA_MARGIN = 200;      // positional gain a capture may bring on top of the material, for delta pruning
+    static const int MAX_EXCHANGES = 64;      // captures followed on one square by the static exchange evaluation
+    static const int ASPIRATION_WINDOW = 100;
+    static const int MAX_ASPIRATION_WINDOW = 1000; // an aspiration window that has to grow wider than this is opened fully
     static const int NULL_MOVE_REDUCTION = 2;
     static const int LATE_MOVE_REDUCTION = 1;
 
+    // Move lists of the search, one per ply from the root (kept off the stack, which is small in webassembly)
+    static const int MAX_SEARCH_PLY = 64;
+    std::vector<MoveList> moveLists;
+    int ply;
+    long long nodes; // positions searched by this solver since nextMove() was called
+
+    // Limits of the current nextMove() call, polled by checkLimits() as the search goes
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point searchStart;
+    void checkLimits();
+
+    // Quiet move ordering, learnt from the quiet moves that caused beta cutoffs
+    MoveCode killers[MAX_SEARCH_PLY][2];                // the last two such moves at each ply, most recent first
+    int history[NUM_SQUARES][NUM_SQUARES];              // [from][to], growing with the depth of each cutoff
+    MoveCode counterMoves[NUM_SQUARES][NUM_SQUARES];    // [from][to] of the opponent's last move -> the move that refuted it
+    void resetOrdering();
+    void clearKillers();
+    void updateOrdering(Board &board, MoveCode move, int depth);
+
+    // Principal variation. Row p of the triangular table is the best line found from ply p on, pvLength[p] moves
+    // long; a node that raises alpha copies its move followed by the row of its child into its own row
+    MoveCode pvTable[MAX_SEARCH_PLY][MAX_SEARCH_PLY];
+    int pvLength[MAX_SEARCH_PLY];
+    void updatePrincipalVariation(MoveCode move);
+    std::vector<MoveCode> principalVariation; // the line of the last completed iteration, searched first by the next
+    bool followPV;                            // is the node searched on that line?
+    std::vector<MoveCode> playedLine;         // the line of the move last returned, which a ponder search leaves alone
+    int principalScore;                       // score of that line, from white's point of view
+
+    // Multi-PV: the root keeps the best multiPV moves instead of just one, each with its line, best first
+    struct RootLine {
+        int score;
+        std::vector<MoveCode> moves;
+    };
+    bool analyzing; // is analyze() searching? Only then does the root fill rootLines, even for a single line
+    int multiPV;
+    std::vector<RootLine> rootLines;
+    void addRootLine(int score);
+
+    // Lazy SMP: helper solvers search the same position on threads of their own, sharing the transposition table.
+    // They only make the table richer; the move played is the one this solver finds
+    int threadCount;
+    std::vector<std::unique_ptr<Solver>> helpers;
+    std::vector<std::thread> helperThreads;
+    std::atomic<bool> stopSearch;  // set when the helpers should give up
+    std::atomic<bool> *stopFlag;   // the stopSearch of the solver that owns this one
+    Solver(Solver *owner);
+    void startHelpers(Board &board);
+    void stopHelpers();
+    void helperSearch(Board board, int firstDepth);
+
+    // Pondering: once the frontend played the move found, this solver goes on searching on a thread of its own, in
+    // the position after the reply it expects. Nothing limits that search until the frontend calls ponderhit()
+    u_int64_t playedKey;            // key of the position after the last move found, for startPonder() to recognise
+    u_int64_t ponderKey;            // key of the position pondered on
+    int ponderColor;                // the side to move there (this solver's)
+    std::thread ponderThread;
+    std::atomic<bool> pondering;    // set while the limits are off
+    MoveCode ponderMove;            // best move of the ponder search
+    int ponderScore;                // and its score, from white's point of view
+    void ponderSearch(Board board, int color);
+
     // Instance methods
-    Turn solve(Board &board, int depth, int ALPHA, int BETA, int color, int score);
+    int solve(Board &board, int depth, int ALPHA, int BETA, int score, MoveCode &bestMove);
     int distance(Coordinate coord);
-    int pieceScore(Piece *piece);
-    bool canPromote(Piece* piece);
-    int mobilityScore(Board &board, Piece *piece);
+    int pieceScore(PieceCode piece, Coordinate location);
+    bool canPromote(PieceCode piece, Coordinate location);
+    int scoreChange(Board &board, MoveCode move);
+    int mobilityScore(Board &board, Coordinate location);
     int kingSafetyScore(Board &board, int color);
     int evaluateLevelControl(Board &board, int color);
     int evaluateSpaceControl(Board &board, int color);
     int evaluateOutposts(Board &board, int color);
+    bool isOutpost(Board &board, Coordinate coord, int color);
     int evaluatePieceCoordination(Board &board, int color);
+    int countSupportingPieces(Board &board, Coordinate coord, int color);
     int evaluateThreats(Board &board, int color);
+    int evaluate3DSpaceControl(Board &board, int color);
+    int evaluate3DPawnColumn(Board &board, int col, int lvl, int color);
+    int evaluate3DPawnStructure(Board &board, int color);
+    int evaluate3DMaterialBalance(Board &board, int color);
+    int materialScore(Board &board);
+    int positionalScore(Board &board);
 
-    int quiescenceSearch(Board &board, int ALPHA, int BETA, int color, int depth, int score);
+    int quiescenceSearch(Board &board, int ALPHA, int BETA, int depth, int score);
     bool isEndgame(Board &board);
+    bool shouldApplyNullMove(Board &board, int color, int depth);
+    void startSearch(Board &board, int color, SearchLimits searchLimits);
+    int iterativeDeepening(Board &board, int maxDepth, MoveCode &bestMove);
+    int aspirationSearch(Board &board, int depth, int previousScore, MoveCode &bestMove);
+    bool shouldStopSearch(std::chrono::steady_clock::time_point startTime);
+    bool probeTranspositionTable(u_int64_t key, int depth, int alpha, int beta, int &score, MoveCode &bestMove);
+    int scoreToTable(int score) const;   // mate scores counted from the root become counted from the position at ply
+    int scoreFromTable(int score) const; // and back
 
-    // Static variables
-    static std::unordered_map<char, int> pieceWeight;
-    static int pieceSquareTable[BOARD_SIZE][BOARD_SIZE][BOARD_SIZE];
+    // Results of earlier searches, kept across nextMove() calls
+    std::shared_ptr<TranspositionTable> transpositionTable;
 
     // Random number generator
     static std::random_device m_rd;
     static std::mt19937 m_rng;
     static std::uniform_int_distribution<int> rng;
 
+    friend class MovePicker;
+
 public:
     static const int INF = 1e7;
 
-    // Constructor
+    // Difficulty levels, as passed in by the frontend
+    static const int EASY = 0;
+    static const int MEDIUM = 1;
+    static const int HARD_MODE = 2;
+
+    // Constructors; the second sets the transposition table size in megabytes
     Solver(int);
+    Solver(int, int);
+    ~Solver();
+
+    // Search threads, this one included (1 if the build has no threads, at most SEARCH_THREAD_POOL in webassembly)
+    void setThreads(int count);
+    int getThreads() const;
+    double getNodes() const; // positions searched by the last nextMove(), on all threads (a double for javascript)
 
     // Useful utility methods
     int evaluate(Board &board);
-    Turn nextMove(Board &board, int color);
-    std::vector<Turn> genMoves(Board &board, int color);
+    int materialGain(Board &board, MoveCode move);    // the piece move takes, plus its promotion
+    int staticExchange(Board &board, MoveCode move);  // what move wins once the exchanges on its square are over
+    Turn nextMove(Board &board, int color); // searches within the limits of the difficulty
+    Turn nextMoveWithLimits(Board &board, int color, SearchLimits searchLimits);
+    SearchLimits getDefaultLimits() const;
+    vector<Turn> getPrincipalVariation() const; // the line the last nextMove() expects, its move first
+    // Multi-PV analysis: the best "lines" moves in one search, best first, each followed by the line it expects.
+    // Every turn of a line carries the line's score
+    vector<vector<Turn>> analyze(Board &board, int color, SearchLimits searchLimits, int lines);
+
+    // Pondering, for builds with threads. After playing the move of nextMove() (or ponderhit()), startPonder() is
+    // called with the board and the side to move (the opponent's): it returns false if it has nothing to ponder on
+    // (no reply expected, or no threads). When it is this solver's turn again, ponderhit() returns the move to
+    // play: if the opponent played the expected reply, the ponder search goes on under the usual limits, its time
+    // counted from when it started; if not, it is stopped and a new search made, the transposition table keeping
+    // what it found
+    bool startPonder(Board &board, int color);
+    Turn ponderhit(Board &board, int color);
+    void stopPonder(); // ends a ponder search in progress, if any
+
+    void genMoves(Board &board, MoveList &moves);
     static int randRange(int low, int high);
 };
 
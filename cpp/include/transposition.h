@@ -0,0 +1,67 @@
+/* TranspositionTable class. A fixed-size hash table of search results, keyed by Zobrist key (see zobrist.h) and shared
+* by all search threads */
+
+#ifndef transposition_h
+#define transposition_h
+
+#include "movelist.h"
+#include "globals.h"
+#include <atomic>
+
+// Enums
+enum EvaluationFlags {
+    EXACT,
+    LOWER_BOUND,
+    UPPER_BOUND
+};
+
+// Struct for Transposition Table Entry
+struct TTEntry {
+    u_int64_t key;
+    int score;
+    MoveCode bestMove;
+    int depth;
+    int flag;       // an EvaluationFlags value
+    int generation; // the search that stored the entry (modulo 64), see newSearch()
+};
+
+/* How an entry is kept in the table: its fields packed in one 64 bit word, next to the key XORed with that word.
+* Search threads read and write slots without locks, so a slot may be torn by two threads storing at once; the
+* XOR makes a torn slot fail the key check instead of returning another position's data.
+*/
+struct TTSlot {
+    std::atomic<u_int64_t> check; // key ^ data
+    std::atomic<u_int64_t> data;
+};
+
+/* Slots are grouped in buckets of one cache line, so a probe touches a single line. The first slots of a bucket
+* keep the deepest results, preferring those of the current search; the last slot always takes the newest result
+* that did not earn a place there.
+*/
+const int BUCKET_SIZE = 4;
+
+struct alignas(64) TTBucket {
+    TTSlot slots[BUCKET_SIZE];
+};
+
+class TranspositionTable {
+    private:
+        vector<TTBucket> buckets; // a power of two of them
+        u_int64_t mask;           // buckets.size() - 1
+        int generation;
+
+    public:
+        static const int DEFAULT_MEGABYTES = 16;
+
+        TranspositionTable(int megabytes = DEFAULT_MEGABYTES);
+        void resize(int megabytes); // the largest power of two of buckets that fits, emptied
+        void clear();
+        void newSearch(); // ages the entries stored so far, making them the first to be replaced
+
+        bool probe(u_int64_t key, TTEntry& entry) const; // copies the entry of key if it is stored
+        void store(u_int64_t key, int depth, int score, int flag, MoveCode bestMove);
+
+        int getMegabytes() const;
+};
+
+#endif
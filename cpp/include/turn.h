@@ -14,7 +14,8 @@ class Turn {
         Coordinate currentLocation;
         Move change;
         
-        // Constructor
+        // Constructors
+        Turn();
         Turn(int, Coordinate, Move);
 
         // Assignment operator overload
@@ -0,0 +1,19 @@
+/* Zobrist keys. A position's key is the XOR of one random 64 bit number per (piece type, color, square) on the board,
+* plus one more when black is to move, so a move only XORs a few numbers in and out of the key
+*/
+
+#ifndef zobrist_h
+#define zobrist_h
+
+#include "globals.h"
+#include "piecetype.h"
+#include <array>
+
+extern const std::array<std::array<u_int64_t, NUM_SQUARES>, 2 * KING + 1> ZOBRIST_PIECES; // [code + KING][square], zero for EMPTY
+extern const u_int64_t ZOBRIST_BLACK_TO_MOVE;
+
+inline u_int64_t zobristKey(PieceCode code, int square) {
+    return ZOBRIST_PIECES[code + KING][square];
+}
+
+#endif
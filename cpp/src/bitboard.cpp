@@ -0,0 +1,94 @@
+#include "../include/bitboard.h"
+
+// Builds, at compile time, the attack set of a piece jumping by each of the given steps
+template <size_t N>
+constexpr std::array<Bitboard, NUM_SQUARES> leaperAttacks(const Direction (&steps)[N]) {
+    std::array<Bitboard, NUM_SQUARES> attacks{};
+    for (int square = 0; square < NUM_SQUARES; ++square) {
+        for (const Direction& step : steps) {
+            int target = stepSquare(square, step);
+            if (target != -1) attacks[square] |= squareBit(target);
+        }
+    }
+    return attacks;
+}
+
+constexpr std::array<Bitboard, NUM_SQUARES> KNIGHT_ATTACKS = leaperAttacks(KNIGHT_JUMPS);
+constexpr std::array<Bitboard, NUM_SQUARES> KING_ATTACKS = leaperAttacks(DIRECTIONS);
+constexpr std::array<Bitboard, NUM_SQUARES> PAWN_ATTACKS[2] = {leaperAttacks(PAWN_CAPTURE_STEPS[0]), leaperAttacks(PAWN_CAPTURE_STEPS[1])};
+constexpr std::array<Bitboard, NUM_SQUARES> PAWN_PUSHES[2] = {leaperAttacks(PAWN_PUSH_STEPS[0]), leaperAttacks(PAWN_PUSH_STEPS[1])};
+
+// (isPromotionSquare() only looks at the sign of the color, and WHITE and BLACK are not compile-time constants)
+constexpr Bitboard promotionSquares(int sign) {
+    Bitboard squares = 0;
+    for (int square = 0; square < NUM_SQUARES; ++square) {
+        if (isPromotionSquare(sign, square)) squares |= squareBit(square);
+    }
+    return squares;
+}
+
+constexpr Bitboard PROMOTION_SQUARES[2] = {promotionSquares(1), promotionSquares(-1)};
+
+constexpr std::array<std::array<LineInfo, NUM_SQUARES>, NUM_AXES> buildLines() {
+    std::array<std::array<LineInfo, NUM_SQUARES>, NUM_AXES> lines{};
+    for (int axis = 0; axis < NUM_AXES; ++axis) {
+        // the positive direction of the axis
+        int dr = DIRECTIONS[2 * axis].row, dc = DIRECTIONS[2 * axis].col, dl = DIRECTIONS[2 * axis].lvl;
+        int step = Raumschach::offset({dr, dc, dl});
+        int start = 0;
+        // lines are laid out in the rotated occupancy in the order of their first square
+        for (int first = 0; first < NUM_SQUARES; ++first) {
+            int row = Raumschach::coordinate(first, 0), col = Raumschach::coordinate(first, 1), lvl = Raumschach::coordinate(first, 2);
+            if (isOnBoard(row - dr, col - dc, lvl - dl)) continue; // not the first square of its line
+            int length = 0;
+            while (isOnBoard(row + length * dr, col + length * dc, lvl + length * dl)) ++length;
+            for (int position = 0; position < length; ++position) {
+                LineInfo& line = lines[axis][first + position * step];
+                line.first = (unsigned char)first;
+                line.start = (unsigned char)start;
+                line.length = (unsigned char)length;
+                line.position = (unsigned char)position;
+            }
+            start += length;
+        }
+    }
+    return lines;
+}
+
+constexpr std::array<std::array<unsigned char, 1 << BOARD_SIZE>, BOARD_SIZE> buildLineAttacks() {
+    std::array<std::array<unsigned char, 1 << BOARD_SIZE>, BOARD_SIZE> attacks{};
+    for (int position = 0; position < BOARD_SIZE; ++position) {
+        for (int occupancy = 0; occupancy < (1 << BOARD_SIZE); ++occupancy) {
+            int reachable = 0;
+            // slide both ways, stopping on (and including) the first occupied position
+            for (int i = position + 1; i < BOARD_SIZE; ++i) {
+                reachable |= 1 << i;
+                if (occupancy & (1 << i)) break;
+            }
+            for (int i = position - 1; i >= 0; --i) {
+                reachable |= 1 << i;
+                if (occupancy & (1 << i)) break;
+            }
+            attacks[position][occupancy] = (unsigned char)reachable;
+        }
+    }
+    return attacks;
+}
+
+constexpr std::array<std::array<Bitboard, 1 << BOARD_SIZE>, NUM_AXES> buildLineSpread() {
+    std::array<std::array<Bitboard, 1 << BOARD_SIZE>, NUM_AXES> spread{};
+    for (int axis = 0; axis < NUM_AXES; ++axis) {
+        const Direction& d = DIRECTIONS[2 * axis];
+        int step = Raumschach::offset({d.row, d.col, d.lvl});
+        for (int positions = 0; positions < (1 << BOARD_SIZE); ++positions) {
+            for (int i = 0; i < BOARD_SIZE; ++i) {
+                if (positions & (1 << i)) spread[axis][positions] |= squareBit(i * step);
+            }
+        }
+    }
+    return spread;
+}
+
+constexpr std::array<std::array<LineInfo, NUM_SQUARES>, NUM_AXES> LINES = buildLines();
+constexpr std::array<std::array<unsigned char, 1 << BOARD_SIZE>, BOARD_SIZE> LINE_ATTACKS = buildLineAttacks();
+constexpr std::array<std::array<Bitboard, 1 << BOARD_SIZE>, NUM_AXES> LINE_SPREAD = buildLineSpread();
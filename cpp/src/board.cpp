@@ -9,208 +9,639 @@
 #include "../include/piece.h"
 #include "../include/empty.h"
 #include "../include/globals.h"
+#include <cstdio>
+#include <new>
+
+// views are constructed in slots of sizeof(Piece) bytes, which only works while no piece class adds members
+static_assert(sizeof(Pawn) == sizeof(Piece) && sizeof(Knight) == sizeof(Piece) && sizeof(Bishop) == sizeof(Piece) &&
+              sizeof(Unicorn) == sizeof(Piece) && sizeof(Rook) == sizeof(Piece) && sizeof(Queen) == sizeof(Piece) &&
+              sizeof(King) == sizeof(Piece) && sizeof(Empty) == sizeof(Piece), "piece views must fit in a view slot");
+
+std::atomic<int> Board::liveCount(0);
 
 Board::Board() {
+    ++liveCount;
     // initialize the board
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        for (int j = 0; j < BOARD_SIZE; ++j) {
-            for (int k = 0; k < BOARD_SIZE; ++k) {
-                /* To Denote an empty cell, we simply use a dead piece */
-                board[i][j][k] = new Empty();
-                board[i][j][k]->setIsAlive(false);
-            }
-        }
+    for (int i = 0; i < NUM_SQUARES; ++i) {
+        squares[i] = EMPTY;
+        attacksFrom[i] = attackedBy[i] = 0;
+        views[i] = nullptr;
+    }
+    colorPieces[0] = colorPieces[1] = 0;
+    for (int type = EMPTY; type <= KING; ++type) {
+        typePieces[type] = 0;
+    }
+    for (int axis = 0; axis < NUM_AXES; ++axis) {
+        rotated[axis] = 0;
     }
+    kingSquare[0] = kingSquare[1] = -1;
+    boardKey = 0;
+    sideToMove = WHITE;
+    ply = quietPlies = 0;
+    keyHistory.reserve(MAX_PLY);
+    undoCount = 0;
     // set the board (bottom left back corner is 0, 0, 0)
 
     // set pieces for Level A
-    board[0][0][0] = new Rook(0, 0, 0, WHITE);
-    board[0][4][0] = new Rook(0, 4, 0, WHITE);
-    board[0][1][0] = new Knight(0, 1, 0, WHITE);
-    board[0][3][0] = new Knight(0, 3, 0, WHITE);
-    board[0][2][0] = new King(0, 2, 0, WHITE);
+    setPieceCode({0, 0, 0}, makePieceCode(ROOK, WHITE));
+    setPieceCode({0, 4, 0}, makePieceCode(ROOK, WHITE));
+    setPieceCode({0, 1, 0}, makePieceCode(KNIGHT, WHITE));
+    setPieceCode({0, 3, 0}, makePieceCode(KNIGHT, WHITE));
+    setPieceCode({0, 2, 0}, makePieceCode(KING, WHITE));
     for (int i = 0; i < 5; ++i) {
-        board[1][i][0] = new Pawn(1, i, 0, WHITE);
+        setPieceCode({1, i, 0}, makePieceCode(PAWN, WHITE));
     }
 
 
     // set pieces for Level B
-    board[0][0][1] = new Bishop(0, 0, 1, WHITE);
-    board[0][3][1] = new Bishop(0, 3, 1, WHITE);
-    board[0][1][1] = new Unicorn(0, 1, 1, WHITE);
-    board[0][4][1] = new Unicorn(0, 4, 1, WHITE);
-    board[0][2][1] = new Queen(0, 2, 1, WHITE);
+    setPieceCode({0, 0, 1}, makePieceCode(BISHOP, WHITE));
+    setPieceCode({0, 3, 1}, makePieceCode(BISHOP, WHITE));
+    setPieceCode({0, 1, 1}, makePieceCode(UNICORN, WHITE));
+    setPieceCode({0, 4, 1}, makePieceCode(UNICORN, WHITE));
+    setPieceCode({0, 2, 1}, makePieceCode(QUEEN, WHITE));
     for(int i = 0; i < 5; ++i) {
-        board[1][i][1] = new Pawn(1, i, 1, WHITE);
+        setPieceCode({1, i, 1}, makePieceCode(PAWN, WHITE));
     }
 
     // set pieces for Level D
-    board[4][0][3] = new Bishop(4, 0, 3, BLACK);
-    board[4][3][3] = new Bishop(4, 3, 3, BLACK);
-    board[4][1][3] = new Unicorn(4, 1, 3, BLACK);
-    board[4][4][3] = new Unicorn(4, 4, 3, BLACK);
-    board[4][2][3] = new Queen(4, 2, 3, BLACK);
+    setPieceCode({4, 0, 3}, makePieceCode(BISHOP, BLACK));
+    setPieceCode({4, 3, 3}, makePieceCode(BISHOP, BLACK));
+    setPieceCode({4, 1, 3}, makePieceCode(UNICORN, BLACK));
+    setPieceCode({4, 4, 3}, makePieceCode(UNICORN, BLACK));
+    setPieceCode({4, 2, 3}, makePieceCode(QUEEN, BLACK));
     for(int i = 0; i < 5; ++i) {
-        board[3][i][3] = new Pawn(3, i, 3, BLACK);
+        setPieceCode({3, i, 3}, makePieceCode(PAWN, BLACK));
     }
 
     // set pieces for Level E
-    board[4][0][4] = new Rook(4, 0, 4, BLACK);
-    board[4][4][4] = new Rook(4, 4, 4, BLACK);
-    board[4][1][4] = new Knight(4, 1, 4, BLACK);
-    board[4][3][4] = new Knight(4, 3, 4, BLACK);
-    board[4][2][4] = new King(4, 2, 4, BLACK);
+    setPieceCode({4, 0, 4}, makePieceCode(ROOK, BLACK));
+    setPieceCode({4, 4, 4}, makePieceCode(ROOK, BLACK));
+    setPieceCode({4, 1, 4}, makePieceCode(KNIGHT, BLACK));
+    setPieceCode({4, 3, 4}, makePieceCode(KNIGHT, BLACK));
+    setPieceCode({4, 2, 4}, makePieceCode(KING, BLACK));
     for(int i = 0; i < 5; ++i) {
-        board[3][i][4] = new Pawn(3, i, 4, BLACK);
+        setPieceCode({3, i, 4}, makePieceCode(PAWN, BLACK));
     }
 }
 
+Board::Board(const Board& other) {
+    ++liveCount;
+    // views are not shared; the copy rebuilds its own on demand
+    for (int i = 0; i < NUM_SQUARES; ++i) {
+        views[i] = nullptr;
+    }
+    *this = other;
+}
+
+Board& Board::operator=(const Board& other) {
+    // copy the position only
+    for (int i = 0; i < NUM_SQUARES; ++i) {
+        squares[i] = other.squares[i];
+        attacksFrom[i] = other.attacksFrom[i];
+        attackedBy[i] = other.attackedBy[i];
+    }
+    colorPieces[0] = other.colorPieces[0];
+    colorPieces[1] = other.colorPieces[1];
+    for (int type = EMPTY; type <= KING; ++type) {
+        typePieces[type] = other.typePieces[type];
+    }
+    for (int axis = 0; axis < NUM_AXES; ++axis) {
+        rotated[axis] = other.rotated[axis];
+    }
+    kingSquare[0] = other.kingSquare[0];
+    kingSquare[1] = other.kingSquare[1];
+    boardKey = other.boardKey;
+    sideToMove = other.sideToMove;
+    ply = other.ply;
+    quietPlies = other.quietPlies;
+    keyHistory = other.keyHistory;
+    undoCount = other.undoCount;
+    for (int i = 0; i < undoCount; ++i) {
+        undoStack[i] = other.undoStack[i];
+    }
+    return *this;
+}
+
+Board::~Board() {
+    --liveCount;
+    for (int i = 0; i < NUM_SQUARES; ++i) {
+        if (views[i] != nullptr) views[i]->~Piece();
+    }
+}
+
+int Board::getLiveCount() {
+    return liveCount;
+}
+
+Piece* Board::getView(int square) {
+    PieceCode code = squares[square];
+    Piece* view = views[square];
+    // reuse the existing view if it still describes the square
+    if (view != nullptr && view->getId() == pieceId(pieceTypeOf(code)) && view->getColor() == pieceColorOf(code)) {
+        return view;
+    }
+    if (view != nullptr) view->~Piece();
+
+    Coordinate c = Coordinate::fromSquare(square);
+    int color = pieceColorOf(code);
+    void* slot = viewStorage[square];
+    switch (pieceTypeOf(code)) {
+        case PAWN: view = new (slot) Pawn(c.row, c.col, c.lvl, color); break;
+        case KNIGHT: view = new (slot) Knight(c.row, c.col, c.lvl, color); break;
+        case BISHOP: view = new (slot) Bishop(c.row, c.col, c.lvl, color); break;
+        case UNICORN: view = new (slot) Unicorn(c.row, c.col, c.lvl, color); break;
+        case ROOK: view = new (slot) Rook(c.row, c.col, c.lvl, color); break;
+        case QUEEN: view = new (slot) Queen(c.row, c.col, c.lvl, color); break;
+        case KING: view = new (slot) King(c.row, c.col, c.lvl, color); break;
+        default:
+            /* To Denote an empty cell, we simply use a dead piece */
+            view = new (slot) Empty(c.row, c.col, c.lvl, 0);
+            view->setIsAlive(false);
+    }
+    views[square] = view;
+    return view;
+}
+
 vector<vector<vector<Piece*>>> Board::getBoard() {
+    vector<vector<vector<Piece*>>> board(BOARD_SIZE, vector<vector<Piece*>>(BOARD_SIZE, vector<Piece*>(BOARD_SIZE, NULL)));
+    for (int i = 0; i < NUM_SQUARES; ++i) {
+        Coordinate c = Coordinate::fromSquare(i);
+        board[c.row][c.col][c.lvl] = getView(i);
+    }
     return board;
 }
 
 Piece* Board::getPieceAt(Coordinate square) {
     if (!isOnBoard(square)) return nullptr;
-    return board[square.row][square.col][square.lvl];
+    return getView(square.toSquare());
 }
 
 Piece* Board::getPieceAt(int row, int col, int lvl) {
-    if (!isOnBoard({row, col, lvl})) return nullptr;
-    return board[row][col][lvl];
+    return getPieceAt({row, col, lvl});
+}
+
+PieceCode Board::getPieceCode(Coordinate square) {
+    if (!isOnBoard(square)) return EMPTY;
+    return squares[square.toSquare()];
+}
+
+PieceCode Board::getPieceCode(int row, int col, int lvl) {
+    return getPieceCode({row, col, lvl});
+}
+
+void Board::setPieceCode(Coordinate square, PieceCode code) {
+    setSquare(square.toSquare(), code);
+}
+
+void Board::setSideToMove(int color) {
+    if (color != sideToMove) {
+        sideToMove = color;
+        boardKey ^= ZOBRIST_BLACK_TO_MOVE;
+    }
+}
+
+void Board::setSquare(int square, PieceCode code) {
+    PieceCode old = squares[square];
+    if (old != EMPTY) {
+        colorPieces[colorIndex(pieceColorOf(old))] ^= squareBit(square);
+        typePieces[pieceTypeOf(old)] ^= squareBit(square);
+        // a king leaving its square (unless it already stands elsewhere, as in the middle of a move)
+        if (pieceTypeOf(old) == KING && kingSquare[colorIndex(pieceColorOf(old))] == square) {
+            kingSquare[colorIndex(pieceColorOf(old))] = -1;
+        }
+    }
+    if (code != EMPTY) {
+        colorPieces[colorIndex(pieceColorOf(code))] ^= squareBit(square);
+        typePieces[pieceTypeOf(code)] ^= squareBit(square);
+        if (pieceTypeOf(code) == KING) {
+            kingSquare[colorIndex(pieceColorOf(code))] = square;
+        }
+    }
+    bool occupancyChanged = (old == EMPTY) != (code == EMPTY);
+    if (occupancyChanged) {
+        // the square changes between vacant and occupied
+        for (int axis = 0; axis < NUM_AXES; ++axis) {
+            rotated[axis] ^= squareBit(rotatedIndex(axis, square));
+        }
+    }
+    squares[square] = code;
+    boardKey ^= zobristKey(old, square) ^ zobristKey(code, square);
+
+    setAttacks(square, getAttacks(square, code));
+    if (occupancyChanged) {
+        // the sliders whose lines reach the square are now blocked there, or see past it
+        Bitboard sliders = attackedBy[square] & (typePieces[BISHOP] | typePieces[UNICORN] | typePieces[ROOK] | typePieces[QUEEN]);
+        while (sliders) {
+            int slider = popLsb(sliders);
+            setAttacks(slider, getAttacks(slider, squares[slider]));
+        }
+    }
+}
+
+void Board::setAttacks(int square, Bitboard attacks) {
+    Bitboard changed = attacksFrom[square] ^ attacks;
+    attacksFrom[square] = attacks;
+    while (changed) {
+        attackedBy[popLsb(changed)] ^= squareBit(square);
+    }
+}
+
+Bitboard Board::getOccupied() const {
+    return colorPieces[0] | colorPieces[1];
+}
+
+Bitboard Board::getPieces(int color) const {
+    return colorPieces[colorIndex(color)];
+}
+
+Bitboard Board::getPieces(int color, int type) const {
+    return colorPieces[colorIndex(color)] & typePieces[type];
+}
+
+Bitboard Board::getSliderAttacks(int square, int type) const {
+    // rooks use the rook axes, bishops the bishop axes, unicorns the unicorn axes and queens all of them
+    int first = type == BISHOP ? BISHOP_AXES : (type == UNICORN ? UNICORN_AXES : ROOK_AXES);
+    int last = type == ROOK ? BISHOP_AXES : (type == BISHOP ? UNICORN_AXES : NUM_AXES);
+    Bitboard attacks = 0;
+    for (int axis = first; axis < last; ++axis) {
+        attacks |= lineAttacks(axis, square, rotated[axis]);
+    }
+    return attacks;
+}
+
+Bitboard Board::getAttacks(int square, PieceCode piece) const {
+    switch (pieceTypeOf(piece)) {
+        case PAWN: return PAWN_ATTACKS[colorIndex(pieceColorOf(piece))][square];
+        case KNIGHT: return KNIGHT_ATTACKS[square];
+        case KING: return KING_ATTACKS[square];
+        case EMPTY: return 0;
+        default: return getSliderAttacks(square, pieceTypeOf(piece));
+    }
+}
+
+Bitboard Board::getAttacksFrom(int square) const {
+    return attacksFrom[square];
+}
+
+Bitboard Board::getAttackers(int square) const {
+    return attackedBy[square];
+}
+
+Bitboard Board::getMoveTargets(int square, PieceCode piece) const {
+    int color = pieceColorOf(piece);
+    if (pieceTypeOf(piece) == PAWN) {
+        // pawns only move forward into an empty square, and only capture an ENEMY piece
+        return (PAWN_PUSHES[colorIndex(color)][square] & ~getOccupied()) | (PAWN_ATTACKS[colorIndex(color)][square] & getPieces(-color));
+    }
+    // every other piece may move to any square it attacks that is vacant or holds an enemy piece
+    Bitboard attacks = piece == squares[square] ? attacksFrom[square] : getAttacks(square, piece);
+    return attacks & ~getPieces(color);
+}
+
+Coordinate Board::getKingLocation(int color) {
+    int square = getKingSquare(color);
+    if (square == -1) return Coordinate(-1, -1, -1);
+    return Coordinate::fromSquare(square);
+}
+
+int Board::getKingSquare(int color) const {
+    return kingSquare[colorIndex(color)];
+}
+
+u_int64_t Board::getBoardKey() const {
+    return boardKey;
+}
+
+string Board::getBoardKeyHex() const {
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)boardKey);
+    return hex;
+}
+
+int Board::getSideToMove() const {
+    return sideToMove;
+}
+
+int Board::getPly() const {
+    return ply;
+}
+
+MoveCode Board::getLastMove() const {
+    if (undoCount == 0 || undoStack[undoCount - 1].moved == EMPTY) return NO_MOVE;
+    return makeMoveCode(undoStack[undoCount - 1].from, undoStack[undoCount - 1].to);
+}
+
+bool Board::isRepetition() const {
+    // only positions since the last capture or pawn move can repeat, and only every other one has the same side to move
+    int size = keyHistory.size();
+    for (int back = 2; back <= quietPlies; back += 2) {
+        if (keyHistory[size - back] == boardKey) return true;
+    }
+    return false;
+}
+
+Piece* Board::getKing(int color) {
+    int square = getKingSquare(color);
+    if (square == -1) return nullptr;
+    return getView(square);
 }
 
 bool Board::isOnBoard(Coordinate c) {
     // this coordinate lies within te 5x5x5 board
-    return c.row >= 0 && c.row < BOARD_SIZE && c.col >= 0 && c.col < BOARD_SIZE && c.lvl >= 0 && c.lvl < BOARD_SIZE;
+    return ::isOnBoard(c.row, c.col, c.lvl);
 }
 
 bool Board::isVacant(Coordinate c) {
     if (!isOnBoard(c)) return false;
     // this square is occupied
-    return !board[c.row][c.col][c.lvl]->getIsAlive();
+    return squares[c.toSquare()] == EMPTY;
 }
 
 bool Board::isEnemySquare(Coordinate c, int pieceColor) {
     if (!isOnBoard(c) || isVacant(c)) return false;
     // return true if the piece at C is an enemy of pieceColor
-    return board[c.row][c.col][c.lvl]->getColor() != pieceColor;
+    return pieceColorOf(squares[c.toSquare()]) != pieceColor;
 }
 
+// appends a move of piece from square "from" to each of targets. Pawns reaching their last square promote to a queen
+static void addMoves(PieceCode piece, int from, Bitboard targets, MoveList& moves) {
+    bool pawn = pieceTypeOf(piece) == PAWN;
+    while (targets) {
+        int to = popLsb(targets);
+        moves.add(makeMoveCode(from, to, pawn && isPromotionSquare(pieceColorOf(piece), to) ? QUEEN : EMPTY));
+    }
+}
 
-void Board::updateLocation(Coordinate square, Move movement) {
-    Piece* curPiece = getPieceAt(square);
+void Board::generateMovesFrom(int square, MoveList& moves) const {
+    addMoves(squares[square], square, getMoveTargets(square, squares[square]), moves);
+}
 
-    // FIRST check if the move is legal
-    int newRow = curPiece->getLocation().row + movement.row;
-    int newCol = curPiece->getLocation().col + movement.col;
-    int newLvl = curPiece->getLocation().lvl + movement.lvl;
-    Coordinate newCord = {newRow, newCol, newLvl};
-    if (!isOnBoard(newCord)) return;
-    Piece* nextSquare = board[newRow][newCol][newLvl]; // the piece in the square the current piece is about to move to
-
-    if (!isVacant(newCord) && nextSquare->getColor() == curPiece->getColor()) return;
-
-    // The move should be legal, so we update it on the board,and for the piece
-
-    // update the piece
-    curPiece->setLocation(newCord.row, newCord.col, newCord.lvl);
-
-    // We need to update the board
-    /* To Denote an empty cell, we simply use a dead piece */
-    board[square.row][square.col][square.lvl] = new Empty();
-    board[square.row][square.col][square.lvl]->setIsAlive(false);
-
-    // update board with the piece's new location
-
-    // if there is a piece of opposite color currently occupying the new location, we destroy it
-    nextSquare->setIsAlive(false);
-    board[newRow][newCol][newLvl] = curPiece;
-}
-
-bool Board::isChecked(int pieceColor) {
-    for (int x = 0; x < BOARD_SIZE; ++x) {
-        for (int y = 0; y < BOARD_SIZE; ++y) {
-            for (int z = 0; z < BOARD_SIZE; ++z) {
-                // if the current cell contains a piece, process its possible moves
-                // only process enemy pieces
-                if (board[x][y][z]->getIsAlive() && board[x][y][z]->getColor() != pieceColor) {
-                    vector<Move> possibleMoves = board[x][y][z]->getMoves(*this, false);
-                    if (board[x][y][z]->getId() == 'p') {
-                        // filter down the passive moves for the pawn
-                        for (int i = int(possibleMoves.size()) - 1; i >= 0; --i) {
-                            // count the number of 0's in this move
-                            int zeros = (possibleMoves[i].row == 0) + (possibleMoves[i].col == 0) + (possibleMoves[i].lvl == 0);
-                            if (zeros > 1) {
-                                // its a passive move, delete it
-                                swap(possibleMoves[i], possibleMoves.back());
-                                possibleMoves.pop_back();
-                            }
-                        }
-                    }
-                    for (Move m : possibleMoves) {
-                        if (board[x + m.row][y + m.col][z + m.lvl]->getId() == 'k') {
-                            return true;
-                        }
-                    }
+void Board::generateMoves(int color, MoveList& moves) const {
+    Bitboard pieces = getPieces(color);
+    while (pieces) {
+        generateMovesFrom(popLsb(pieces), moves);
+    }
+}
+
+// can piece slide along direction d (see geometry.h)?
+static bool slidesAlong(PieceCode piece, int d) {
+    switch (pieceTypeOf(piece)) {
+        case QUEEN: return true;
+        case ROOK: return d < BISHOP_DIRECTIONS;
+        case BISHOP: return d >= BISHOP_DIRECTIONS && d < UNICORN_DIRECTIONS;
+        case UNICORN: return d >= UNICORN_DIRECTIONS;
+        default: return false;
+    }
+}
+
+// Walks the line from square through "through" to the first piece still on the board: the attacker revealed once
+// the piece on through has left (occupied: the squares still holding a piece)
+Bitboard Board::getXRayAttacker(int square, int through, Bitboard occupied) const {
+    int d = directionBetween(square, through);
+    if (d == -1) return 0;
+    const Ray& ray = RAYS[square][d];
+    for (int i = 0; i < ray.length; ++i) {
+        int behind = ray.squares[i];
+        if (!(occupied & squareBit(behind))) continue;
+        return slidesAlong(squares[behind], d) ? squareBit(behind) : 0;
+    }
+    return 0;
+}
+
+void Board::generateLegal(int color, Bitboard fromSquares, Bitboard toSquares, Bitboard pawnToSquares, MoveList& moves) const {
+    int king = getKingSquare(color);
+    if (king == -1) {
+        // without a king every move is legal
+        while (fromSquares) {
+            int from = popLsb(fromSquares);
+            Bitboard allowed = pieceTypeOf(squares[from]) == PAWN ? pawnToSquares : toSquares;
+            addMoves(squares[from], from, getMoveTargets(from, squares[from]) & allowed, moves);
+        }
+        return;
+    }
+    Bitboard enemies = getPieces(-color);
+
+    // Walk the 26 rays out of the king. An enemy slider met first gives check along the ray; one met right
+    // behind a single friendly piece pins that piece to the ray
+    Bitboard blockCheck = 0;    // squares between the king and a sliding checker, the checker included
+    Bitboard kingForbidden = 0; // squares behind the king on a sliding checker's line, still attacked once the king steps there
+    int pinnedSquare[NUM_DIRECTIONS];
+    Bitboard pinLine[NUM_DIRECTIONS];
+    int numPinned = 0;
+    for (int d = 0; d < NUM_DIRECTIONS; ++d) {
+        const Ray& ray = RAYS[king][d];
+        Bitboard line = 0;
+        int blocker = -1;
+        for (int i = 0; i < ray.length; ++i) {
+            int square = ray.squares[i];
+            PieceCode piece = squares[square];
+            line |= squareBit(square);
+            if (piece == EMPTY) continue;
+            if (pieceColorOf(piece) == color) {
+                if (blocker != -1) break; // two friendly pieces: nothing is pinned
+                blocker = square;
+                continue;
+            }
+            if (slidesAlong(piece, d)) {
+                if (blocker == -1) {
+                    blockCheck |= line;
+                    if (RAYS[king][d ^ 1].length) kingForbidden |= squareBit(RAYS[king][d ^ 1].squares[0]);
+                } else {
+                    pinnedSquare[numPinned] = blocker;
+                    pinLine[numPinned++] = line;
                 }
             }
+            break;
         }
     }
-    return false;
-}
 
-bool Board::isCheckmated(int pieceColor) {
-    // Naive approach: try all possible moves, and if there exists at least 1 move that puts the king
-    // out of check, return false
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        for (int j = 0; j < BOARD_SIZE; ++j) {
-            for (int k = 0; k < BOARD_SIZE; ++k) {
-                if (board[i][j][k]->getIsAlive() && board[i][j][k]->getColor() == pieceColor) {
-                    // try out all possible moves of this piece, and check if the king is still checked
-                    for (Move m : board[i][j][k]->getMoves(*this, false)) {
-                        Coordinate newCoord = Coordinate(i, j, k) + m;
-                        Piece* oldPiece = board[newCoord.row][newCoord.col][newCoord.lvl];
-                        updateLocation({i, j, k}, m);
-                        bool checked = isChecked(pieceColor);
-                        // undo the move
-                        updateLocation(newCoord, -m);
-                        if(oldPiece->getId() != ' '){
-                            board[newCoord.row][newCoord.col][newCoord.lvl] = oldPiece;
-                            oldPiece->setIsAlive(true);
-                        }
-                        if(!checked) return false;
-                    }
-                }
+    // With one checker, other pieces must capture it or block its line; with two, only the king can move
+    Bitboard checkers = attackedBy[king] & enemies;
+    Bitboard evasions = ~Bitboard(0);
+    if (popCount(checkers) > 1) {
+        evasions = 0;
+    } else if (checkers) {
+        evasions = checkers | blockCheck;
+    }
+
+    while (fromSquares) {
+        int from = popLsb(fromSquares);
+        Bitboard targets = getMoveTargets(from, squares[from]) & (pieceTypeOf(squares[from]) == PAWN ? pawnToSquares : toSquares);
+        if (from == king) {
+            // the king may not step onto an attacked square
+            Bitboard safe = 0;
+            while (targets) {
+                int to = popLsb(targets);
+                if (!(attackedBy[to] & enemies)) safe |= squareBit(to);
+            }
+            targets = safe & ~kingForbidden;
+        } else {
+            targets &= evasions;
+            for (int i = 0; i < numPinned; ++i) {
+                // a pinned piece can only move along its pin
+                if (pinnedSquare[i] == from) targets &= pinLine[i];
             }
         }
+        addMoves(squares[from], from, targets, moves);
     }
-    return true; // game over
 }
 
-bool Board::isStalemated(int pieceColor) {
+void Board::generateLegalMovesFrom(int square, MoveList& moves) const {
+    if (squares[square] == EMPTY) return;
+    generateLegal(pieceColorOf(squares[square]), squareBit(square), ~Bitboard(0), ~Bitboard(0), moves);
+}
+
+void Board::generateLegalMoves(int color, MoveList& moves) const {
+    generateLegal(color, getPieces(color), ~Bitboard(0), ~Bitboard(0), moves);
+}
+
+// Pawn pushes onto the promotion squares count as captures: they win material too
+void Board::generateLegalCaptures(int color, MoveList& moves) const {
+    Bitboard enemies = getPieces(-color);
+    generateLegal(color, getPieces(color), enemies, enemies | (PROMOTION_SQUARES[colorIndex(color)] & ~getOccupied()), moves);
+}
+
+void Board::generateLegalQuiets(int color, MoveList& moves) const {
+    Bitboard empty = ~getOccupied();
+    generateLegal(color, getPieces(color), empty, empty & ~PROMOTION_SQUARES[colorIndex(color)], moves);
+}
+
+bool Board::isLegalMove(MoveCode move) const {
+    int from = moveFrom(move), to = moveTo(move);
+    if (squares[from] == EMPTY || pieceColorOf(squares[from]) != sideToMove) return false;
+    MoveList moves;
+    generateLegal(sideToMove, squareBit(from), squareBit(to), squareBit(to), moves);
+    return moves.size() == 1 && moves[0] == move;
+}
+
+vector<Move> Board::getMovesAt(Coordinate square, bool prune) {
+    vector<Move> result;
+    if (!isOnBoard(square)) return result;
+
+    MoveList moves;
+    if (prune) {
+        // Only the legal moves (that do not place its king in check)
+        generateLegalMovesFrom(square.toSquare(), moves);
+    } else {
+        generateMovesFrom(square.toSquare(), moves);
+    }
+    for (MoveCode m : moves) {
+        result.push_back(Coordinate::fromSquare(moveTo(m)) - square);
+    }
+    return result;
+}
+
+void Board::updateLocation(Coordinate square, Move movement) {
+    if (!isOnBoard(square) || isVacant(square)) return;
+    PieceCode curPiece = squares[square.toSquare()];
+
+    // FIRST check if the move is legal
+    Coordinate newCord = square + movement;
+    if (!isOnBoard(newCord)) return;
+
+    if (!isVacant(newCord) && pieceColorOf(squares[newCord.toSquare()]) == pieceColorOf(curPiece)) return;
+
+    // The move should be legal, so we update it on the board
+    // if there is a piece of opposite color currently occupying the new location, it is overwritten (captured)
+    bool quiet = pieceTypeOf(curPiece) != PAWN && isVacant(newCord);
+    keyHistory.push_back(boardKey);
+    setSquare(newCord.toSquare(), curPiece);
+    setSquare(square.toSquare(), EMPTY);
+    passTurn();
+    quietPlies = quiet ? quietPlies + 1 : 0;
+}
+
+void Board::passTurn() {
+    ++ply;
+    sideToMove = -sideToMove;
+    boardKey ^= ZOBRIST_BLACK_TO_MOVE;
+}
+
+void Board::makeMove(int from, int to, int promotion) {
+    assert(undoCount < MAX_PLY);
+    UndoInfo& undo = undoStack[undoCount++];
+    undo.from = (unsigned char)from;
+    undo.to = (unsigned char)to;
+    undo.moved = squares[from];
+    undo.captured = squares[to];
+    undo.quietPlies = quietPlies;
+
+    // the position is recorded before the move so isRepetition() can find it
+    keyHistory.push_back(boardKey);
+    // whatever stands on the target square is captured
+    setSquare(to, promotion == EMPTY ? undo.moved : makePieceCode(promotion, pieceColorOf(undo.moved)));
+    setSquare(from, EMPTY);
+    passTurn();
+    quietPlies = (pieceTypeOf(undo.moved) != PAWN && undo.captured == EMPTY) ? quietPlies + 1 : 0;
+}
+
+void Board::makeMove(MoveCode move) {
+    makeMove(moveFrom(move), moveTo(move), movePromotion(move));
+}
+
+void Board::makeMove(Coordinate square, Move movement, int promotion) {
+    makeMove(square.toSquare(), (square + movement).toSquare(), promotion);
+}
+
+void Board::unmakeMove() {
+    assert(undoCount > 0);
+    const UndoInfo& undo = undoStack[--undoCount];
+    // put the moved piece back (as a pawn if it promoted) and restore the captured piece
+    setSquare(undo.from, undo.moved);
+    setSquare(undo.to, undo.captured);
+    boardKey = keyHistory.back();
+    keyHistory.pop_back();
+    --ply;
+    sideToMove = -sideToMove;
+    quietPlies = undo.quietPlies;
+}
+
+void Board::makeNullMove() {
+    assert(undoCount < MAX_PLY);
+    UndoInfo& undo = undoStack[undoCount++];
+    undo.moved = EMPTY; // marks a null move
+    undo.quietPlies = quietPlies;
+    keyHistory.push_back(boardKey);
+    passTurn();
+    // a position reached through a null move is not a real repetition
+    quietPlies = 0;
+}
+
+void Board::unmakeNullMove() {
+    assert(undoCount > 0 && undoStack[undoCount - 1].moved == EMPTY);
+    quietPlies = undoStack[--undoCount].quietPlies;
+    boardKey = keyHistory.back();
+    keyHistory.pop_back();
+    --ply;
+    sideToMove = -sideToMove;
+}
+
+bool Board::isSquareAttacked(int square, int byColor) const {
+    return (attackedBy[square] & getPieces(byColor)) != 0;
+}
+
+bool Board::isChecked(int pieceColor) const {
+    int king = getKingSquare(pieceColor);
+    return king != -1 && isSquareAttacked(king, -pieceColor);
+}
+
+bool Board::isCheckmated(int pieceColor) const {
+    // If there exists at least 1 move that puts the king out of check, return false
+    MoveList moves;
+    generateLegalMoves(pieceColor, moves);
+    return moves.empty();
+}
+
+bool Board::isStalemated(int pieceColor) const {
     // By definition of stalemate, the king should not be currently in check
     if (isChecked(pieceColor)) return false;
     // If we manage to find even one valid move for the current turn player, return false
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        for (int j = 0; j < BOARD_SIZE; ++j) {
-            for (int k = 0; k < BOARD_SIZE; ++k) {
-                if (board[i][j][k]->getIsAlive() && board[i][j][k]->getColor() == pieceColor) {
-                    if (board[i][j][k]->hasAnyMoves(*this, {i,j,k})) {
-                        // Found a legal valid move
-                        return false;
-                    }
-                }
-            }
-        }
-    }
-    return true;
+    MoveList moves;
+    generateLegalMoves(pieceColor, moves);
+    return moves.empty();
 }
 
 string Board::getGameState(int turnPlayer) {
-
-    // Get your opponent's color
-    int opponent = -turnPlayer;
-
     string yourColor = (turnPlayer == WHITE ? "White" : "Black");
     string oppColor = (turnPlayer == WHITE ? "Black" : "White");
 
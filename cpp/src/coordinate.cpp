@@ -18,10 +18,14 @@ Coordinate::Coordinate(Coordinate cur, Move delta) {
     lvl = cur.lvl + delta.lvl;
 }
 
-Coordinate Coordinate::operator+(const Move &delta){
+Coordinate Coordinate::operator+(const Move &delta) const {
     return Coordinate(row + delta.row, col + delta.col, lvl + delta.lvl);
 }
 
+Move Coordinate::operator-(const Coordinate &other) const {
+    return Move(row - other.row, col - other.col, lvl - other.lvl);
+}
+
 Coordinate& Coordinate::operator+=(const Move &delta){
     this->row += delta.row;
     this->col += delta.col;
@@ -40,3 +44,10 @@ string Coordinate::toString() {
     return "(" + to_string(row) + ", " + to_string(col) + ", " + to_string(lvl) + ")";
 }
 
+int Coordinate::toSquare() {
+    return Raumschach::toSquare({row, col, lvl});
+}
+
+Coordinate Coordinate::fromSquare(int square) {
+    return Coordinate(Raumschach::coordinate(square, 0), Raumschach::coordinate(square, 1), Raumschach::coordinate(square, 2));
+}
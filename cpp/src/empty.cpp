@@ -4,7 +4,7 @@ char Empty::getId() {
     return ' ';
 }
 
-vector<Move> Empty::getMoves(Board board, bool prune) {
+vector<Move> Empty::getMoves(Board& board, bool prune) {
     vector<Move> emptyVector;
     return emptyVector;
 }
\ No newline at end of file
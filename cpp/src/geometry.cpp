@@ -0,0 +1,29 @@
+#include "../include/geometry.h"
+
+constexpr std::array<std::array<Ray, NUM_DIRECTIONS>, NUM_SQUARES> buildRays() {
+    std::array<std::array<Ray, NUM_DIRECTIONS>, NUM_SQUARES> rays{};
+    for (int square = 0; square < NUM_SQUARES; ++square) {
+        for (int d = 0; d < NUM_DIRECTIONS; ++d) {
+            Ray& ray = rays[square][d];
+            // keep stepping until we fall off the board
+            for (int cur = stepSquare(square, DIRECTIONS[d]); cur != -1; cur = stepSquare(cur, DIRECTIONS[d])) {
+                ray.squares[ray.length++] = (unsigned char)cur;
+            }
+        }
+    }
+    return rays;
+}
+
+constexpr std::array<Neighbours, NUM_SQUARES> buildNeighbours(int numDirections) {
+    std::array<Neighbours, NUM_SQUARES> neighbours{};
+    for (int square = 0; square < NUM_SQUARES; ++square) {
+        for (int d = 0; d < numDirections; ++d) {
+            int cur = stepSquare(square, DIRECTIONS[d]);
+            if (cur != -1) neighbours[square].squares[neighbours[square].count++] = (unsigned char)cur;
+        }
+    }
+    return neighbours;
+}
+
+constexpr std::array<std::array<Ray, NUM_DIRECTIONS>, NUM_SQUARES> RAYS = buildRays();
+constexpr std::array<Neighbours, NUM_SQUARES> NEIGHBOURS = buildNeighbours(NUM_DIRECTIONS);
@@ -1,5 +1,4 @@
 #include "../include/globals.h"
 
 int BLACK = -1;
-int WHITE = 1;
-int BOARD_SIZE = 5;
\ No newline at end of file
+int WHITE = 1;
\ No newline at end of file
@@ -11,13 +11,241 @@
 #include "../include/globals.h"
 #include "../include/empty.h"
 #include "../include/solver.h"
+#include "../include/memorystats.h"
 
 // Remove this if you want to run cpp locally
 #include "../include/bindings.h"
 
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
 using namespace std;
 
-int main() {
+#ifndef __EMSCRIPTEN__
+// Lazy SMP scaling report on the opening position, for 1, 2, 4... up to maxThreads threads: the time the main thread
+// takes to complete "depth" plies in hard mode, and the node rate of all the threads together
+void benchThreads(int maxThreads, int depth) {
+    double baseTime = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        Solver solver(Solver::HARD_MODE);
+        solver.setThreads(threads);
+        Board board;
+        SearchLimits limits = {0, 0, depth};
+        auto start = chrono::steady_clock::now();
+        Turn turn = solver.nextMoveWithLimits(board, WHITE, limits);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (threads == 1) baseTime = seconds;
+        printf("threads %2d  depth %d  time %6.2fs  speedup %5.2fx  nodes %10.0f  nodes/s %10.0f  move %s %s\n", threads, depth,
+               seconds, baseTime / seconds, solver.getNodes(), solver.getNodes() / seconds,
+               turn.currentLocation.toString().c_str(), turn.change.toString().c_str());
+    }
+}
+
+static void clearBoard(Board& board) {
+    for (int square = 0; square < NUM_SQUARES; ++square) board.setPieceCode(Coordinate::fromSquare(square), EMPTY);
+}
+
+// Plays a pseudo-random game of legal moves from board, checking every position on the way and again while the moves
+// are taken back
+static void walkRandomGame(Board& board, unsigned seed, int plies, const function<void(Board&)>& check) {
+    mt19937 random(seed);
+    int played = 0;
+    check(board);
+    for (; played < plies; ++played) {
+        MoveList moves;
+        board.generateLegalMoves(board.getSideToMove(), moves);
+        if (moves.empty()) break;
+        board.makeMove(moves[random() % moves.size()]);
+        check(board);
+    }
+    while (played--) {
+        board.unmakeMove();
+        check(board);
+    }
+}
+
+static bool sameMove(Turn a, Turn b) {
+    return a.currentLocation.toSquare() == b.currentLocation.toSquare() &&
+           (a.currentLocation + a.change).toSquare() == (b.currentLocation + b.change).toSquare();
+}
+
+// analyze() asked for a single line, or left with one by a position with a single legal move
+void testAnalyze() {
+    SearchLimits limits = {0, 0, 3};
+    Solver solver(Solver::HARD_MODE);
+    Board board;
+    assert(solver.analyze(board, WHITE, limits, 3).size() == 3);
+    vector<vector<Turn>> lines = solver.analyze(board, WHITE, limits, 1);
+    assert(lines.size() == 1 && !lines[0].empty());
+    Turn turn = solver.nextMoveWithLimits(board, WHITE, limits);
+    assert(sameMove(lines[0][0], turn));
+
+    // the white king's only move is up a row: the rooks guard each other and every other square around the corner
+    Board cornered;
+    clearBoard(cornered);
+    cornered.setPieceCode({0, 0, 0}, makePieceCode(KING, WHITE));
+    cornered.setPieceCode({4, 4, 4}, makePieceCode(KING, BLACK));
+    cornered.setPieceCode({0, 1, 1}, makePieceCode(ROOK, BLACK));
+    cornered.setPieceCode({1, 1, 1}, makePieceCode(ROOK, BLACK));
+    lines = solver.analyze(cornered, WHITE, limits, 3);
+    assert(lines.size() == 1 && sameMove(lines[0][0], Turn(0, Coordinate(0, 0, 0), Move(1, 0, 0))));
+}
+
+// The incrementally updated attack maps agree with the attacks worked out from scratch
+void testAttackMaps() {
+    for (unsigned seed = 1; seed <= 4; ++seed) {
+        Board board;
+        walkRandomGame(board, seed, 200, [](Board& position) {
+            vector<PieceCode> pieces(NUM_SQUARES);
+            for (int square = 0; square < NUM_SQUARES; ++square) pieces[square] = position.getPieceCode(Coordinate::fromSquare(square));
+            for (int square = 0; square < NUM_SQUARES; ++square) {
+                Bitboard attackers = 0;
+                for (int from = 0; from < NUM_SQUARES; ++from)
+                    if (position.getAttacks(from, pieces[from]) & squareBit(square)) attackers |= squareBit(from);
+                assert(position.getAttacksFrom(square) == position.getAttacks(square, pieces[square]));
+                assert(position.getAttackers(square) == attackers);
+            }
+        });
+    }
+}
+static long perft(Board& board, int depth) {
+    MoveList moves;
+    board.generateLegalMoves(board.getSideToMove(), moves);
+    if (depth == 1) return moves.size();
+    long nodes = 0;
+    for (MoveCode move : moves) {
+        board.makeMove(move);
+        nodes += perft(board, depth - 1);
+        board.unmakeMove();
+    }
+    return nodes;
+}
+
+// The legal moves are the pseudo-legal moves that do not leave the king in check, and the opening perft is unchanged
+void testMoveGeneration() {
+    Board opening;
+    assert(perft(opening, 3) == 237775);
+
+    for (unsigned seed = 1; seed <= 4; ++seed) {
+        Board board;
+        walkRandomGame(board, seed, 200, [](Board& position) {
+            int side = position.getSideToMove();
+            MoveList moves, legalMoves;
+            position.generateMoves(side, moves);
+            position.generateLegalMoves(side, legalMoves);
+            vector<MoveCode> expected, legal(legalMoves.begin(), legalMoves.end());
+            for (MoveCode move : moves) {
+                position.makeMove(move);
+                if (!position.isChecked(side)) expected.push_back(move);
+                position.unmakeMove();
+            }
+            sort(expected.begin(), expected.end());
+            sort(legal.begin(), legal.end());
+            assert(legal == expected);
+        });
+    }
+}
+// The incrementally updated key is the one worked out from scratch, and playing a move or a null move and taking it
+// back restores it
+void testZobristKeys() {
+    for (unsigned seed = 1; seed <= 4; ++seed) {
+        Board board;
+        walkRandomGame(board, seed, 200, [](Board& position) {
+            u_int64_t key = position.getSideToMove() == BLACK ? ZOBRIST_BLACK_TO_MOVE : 0;
+            for (int square = 0; square < NUM_SQUARES; ++square) key ^= zobristKey(position.getPieceCode(Coordinate::fromSquare(square)), square);
+            assert(position.getBoardKey() == key);
+
+            MoveList moves;
+            position.generateLegalMoves(position.getSideToMove(), moves);
+            for (MoveCode move : moves) {
+                position.makeMove(move);
+                assert(position.getBoardKey() != key);
+                position.unmakeMove();
+                assert(position.getBoardKey() == key);
+            }
+            position.makeNullMove();
+            assert(position.getBoardKey() == (key ^ ZOBRIST_BLACK_TO_MOVE));
+            position.unmakeNullMove();
+            assert(position.getBoardKey() == key);
+        });
+    }
+}
+// Material the side to move wins on square by taking back with its least valuable piece for as long as it pays,
+// found by playing the captures out
+static int playExchanges(Board& board, int square) {
+    int from = -1, fromType = KING + 1;
+    Bitboard pieces = board.getPieces(board.getSideToMove());
+    while (pieces) {
+        int candidate = popLsb(pieces);
+        PieceCode piece = board.getPieceCode(Coordinate::fromSquare(candidate));
+        if ((board.getMoveTargets(candidate, piece) & squareBit(square)) && pieceTypeOf(piece) < fromType) {
+            from = candidate;
+            fromType = pieceTypeOf(piece);
+        }
+    }
+    if (from < 0) return 0;
+    int taken = PIECE_VALUES[pieceTypeOf(board.getPieceCode(Coordinate::fromSquare(square)))];
+    board.makeMove(from, square);
+    int gain = taken - playExchanges(board, square);
+    board.unmakeMove();
+    return max(0, gain);
+}
+
+// Static exchange evaluation, with rooks lined up behind each other along a column, and against the exchanges played
+// out in random games
+void testStaticExchange() {
+    Solver solver(Solver::HARD_MODE);
+    auto exchangeOn = [&solver](vector<pair<Coordinate, PieceCode>> pieces, Coordinate from, Coordinate to) {
+        Board board;
+        clearBoard(board);
+        board.setPieceCode({0, 0, 0}, makePieceCode(KING, WHITE));
+        board.setPieceCode({4, 4, 4}, makePieceCode(KING, BLACK));
+        for (auto& piece : pieces) board.setPieceCode(piece.first, piece.second);
+        return solver.staticExchange(board, makeMoveCode(from.toSquare(), to.toSquare()));
+    };
+    PieceCode whiteRook = makePieceCode(ROOK, WHITE), blackRook = makePieceCode(ROOK, BLACK);
+    // the pawn is won: the rook behind the first one takes back
+    assert(exchangeOn({{{2, 0, 2}, whiteRook}, {{2, 1, 2}, whiteRook}, {{2, 3, 2}, makePieceCode(PAWN, BLACK)},
+                       {{2, 4, 2}, blackRook}}, {2, 1, 2}, {2, 3, 2}) == 100);
+    // a rook for a pawn: black has a rook behind its first one as well
+    assert(exchangeOn({{{2, 0, 2}, whiteRook}, {{2, 1, 2}, whiteRook}, {{2, 2, 2}, makePieceCode(PAWN, BLACK)},
+                       {{2, 3, 2}, blackRook}, {{2, 4, 2}, blackRook}}, {2, 1, 2}, {2, 2, 2}) == -400);
+    // a knight for a pawn
+    assert(exchangeOn({{{1, 1, 2}, makePieceCode(PAWN, WHITE)}, {{2, 2, 2}, makePieceCode(KNIGHT, BLACK)},
+                       {{3, 3, 2}, makePieceCode(PAWN, BLACK)}}, {1, 1, 2}, {2, 2, 2}) == 300);
+
+    for (unsigned seed = 1; seed <= 4; ++seed) {
+        Board board;
+        walkRandomGame(board, seed, 200, [&solver](Board& position) {
+            MoveList captures;
+            position.generateLegalCaptures(position.getSideToMove(), captures);
+            for (MoveCode capture : captures) {
+                int exchange = solver.staticExchange(position, capture);
+                int gain = solver.materialGain(position, capture);
+                position.makeMove(capture);
+                assert(exchange == gain - playExchanges(position, moveTo(capture)));
+                position.unmakeMove();
+            }
+        });
+    }
+}
+#endif
+
+int main(int argc, char** argv) {
+#ifndef __EMSCRIPTEN__
+    // "bench [threads [depth]]" prints the scaling report, for 1, 2 and 4 threads by default
+    if (argc > 1 && string(argv[1]) == "bench") {
+        benchThreads(argc > 2 ? atoi(argv[2]) : 4, argc > 3 ? atoi(argv[3]) : 8);
+        return 0;
+    }
+
+    testAttackMaps();
+    testMoveGeneration();
+    testZobristKeys();
+    testStaticExchange();
+    testAnalyze();
+#endif
 
     cout << "Tests passed succesfully" << endl;
 }
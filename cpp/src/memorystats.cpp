@@ -0,0 +1,18 @@
+#include "../include/memorystats.h"
+#include "../include/board.h"
+#include "../include/piece.h"
+#include <malloc.h>
+
+MemoryStats getMemoryStats() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 info = mallinfo2(); // glibc deprecates mallinfo() for the 64 bit version
+#else
+    struct mallinfo info = mallinfo();
+#endif
+    MemoryStats stats;
+    stats.heapSize = (int)info.arena;
+    stats.heapUsed = (int)info.uordblks;
+    stats.liveBoards = Board::getLiveCount();
+    stats.livePieces = Piece::getLiveCount();
+    return stats;
+}
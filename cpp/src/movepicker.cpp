@@ -0,0 +1,127 @@
+#include "../include/movepicker.h"
+#include "../include/solver.h"
+
+MovePicker::MovePicker(Solver &solver_, Board &board_, MoveList &moves_, MoveCode ttMove_, int ply)
+    : solver(solver_), board(board_), moves(moves_), stage(TT_MOVE), ttMove(ttMove_), refutationIndex(0), current(0),
+      badCaptures(0), quietsStart(0) {
+    moves.clear();
+    refutations[0] = solver.killers[ply][0];
+    refutations[1] = solver.killers[ply][1];
+    MoveCode lastMove = board.getLastMove();
+    refutations[2] = lastMove == NO_MOVE ? NO_MOVE : solver.counterMoves[moveFrom(lastMove)][moveTo(lastMove)];
+}
+
+MovePicker::MovePicker(Solver &solver_, Board &board_, MoveList &moves_)
+    : solver(solver_), board(board_), moves(moves_), stage(QUIESCENCE_CAPTURES), ttMove(NO_MOVE), refutationIndex(0),
+      current(0), badCaptures(0), quietsStart(0) {
+    moves.clear();
+    board.generateLegalCaptures(board.getSideToMove(), moves);
+    scoreCaptures();
+}
+
+// Most valuable victim first, then least valuable attacker; a promotion counts as taking the piece the pawn becomes
+void MovePicker::scoreCaptures() {
+    for (int i = 0; i < moves.size(); ++i) {
+        MoveCode move = moves[i];
+        PieceCode victim = board.squares[moveTo(move)];
+        int gained = victim != EMPTY ? pieceTypeOf(victim) : movePromotion(move);
+        moves.setScore(i, MVV_LVA[gained][pieceTypeOf(board.squares[moveFrom(move)])]);
+    }
+}
+
+int MovePicker::pickBest(int end) {
+    int best = current;
+    for (int i = current + 1; i < end; ++i) {
+        if (moves.getScore(i) > moves.getScore(best)) best = i;
+    }
+    moves.swap(current, best);
+    return current;
+}
+
+bool MovePicker::isRefutation(MoveCode move) const {
+    return move == refutations[0] || move == refutations[1] || move == refutations[2];
+}
+
+// Does the capture lose material once the exchange on its square is played out? Winning at least the attacker's
+// worth never does, which saves most of the exchange evaluations
+bool MovePicker::isLosing(MoveCode move) const {
+    if (solver.materialGain(board, move) >= PIECE_VALUES[pieceTypeOf(board.squares[moveFrom(move)])]) return false;
+    return solver.staticExchange(board, move) < 0;
+}
+
+MoveCode MovePicker::next() {
+    switch (stage) {
+        case TT_MOVE:
+            stage = GENERATE_CAPTURES;
+            if (ttMove != NO_MOVE && board.isLegalMove(ttMove)) return ttMove;
+            ttMove = NO_MOVE;
+            // fall through
+        case GENERATE_CAPTURES:
+            board.generateLegalCaptures(board.getSideToMove(), moves);
+            scoreCaptures();
+            quietsStart = moves.size();
+            stage = GOOD_CAPTURES;
+            // fall through
+        case GOOD_CAPTURES:
+            while (current < quietsStart) {
+                MoveCode move = moves[pickBest(quietsStart)];
+                ++current;
+                if (move == ttMove) continue;
+                if (isLosing(move)) {
+                    // put aside at the front, where the moves already picked were
+                    moves.swap(badCaptures++, current - 1);
+                    continue;
+                }
+                return move;
+            }
+            stage = KILLERS;
+            // fall through
+        case KILLERS:
+            while (refutationIndex < 3) {
+                MoveCode move = refutations[refutationIndex++];
+                if (move == NO_MOVE || move == ttMove || board.squares[moveTo(move)] != EMPTY) continue;
+                // the countermove may also be a killer
+                if (refutationIndex == 2 && move == refutations[0]) continue;
+                if (refutationIndex == 3 && (move == refutations[0] || move == refutations[1])) continue;
+                if (board.isLegalMove(move)) return move;
+            }
+            stage = GENERATE_QUIETS;
+            // fall through
+        case GENERATE_QUIETS: {
+            board.generateLegalQuiets(board.getSideToMove(), moves);
+            int color = board.getSideToMove();
+            for (int i = quietsStart; i < moves.size(); ++i) {
+                // by how often the move caused cutoffs, breaking ties by how much it improves the piece's position
+                MoveCode move = moves[i];
+                moves.setScore(i, solver.history[moveFrom(move)][moveTo(move)] + solver.scoreChange(board, move) * color);
+            }
+            current = quietsStart;
+            stage = QUIETS;
+        }
+            // fall through
+        case QUIETS:
+            while (current < moves.size()) {
+                MoveCode move = moves[pickBest(moves.size())];
+                ++current;
+                if (move == ttMove || isRefutation(move)) continue;
+                return move;
+            }
+            current = 0;
+            stage = BAD_CAPTURES;
+            // fall through
+        case BAD_CAPTURES:
+            if (current < badCaptures) return moves[current++];
+            stage = DONE;
+            return NO_MOVE;
+        case QUIESCENCE_CAPTURES:
+            while (current < moves.size()) {
+                MoveCode move = moves[pickBest(moves.size())];
+                ++current;
+                if (!isLosing(move)) return move;
+            }
+            stage = DONE;
+            return NO_MOVE;
+        default:
+            return NO_MOVE;
+    }
+}
@@ -0,0 +1,27 @@
+#include "../include/piecetype.h"
+
+char pieceId(int type) {
+    switch (type) {
+        case PAWN: return 'p';
+        case KNIGHT: return 'n';
+        case BISHOP: return 'b';
+        case UNICORN: return 'u';
+        case ROOK: return 'r';
+        case QUEEN: return 'q';
+        case KING: return 'k';
+        default: return ' ';
+    }
+}
+
+int pieceTypeFromId(char id) {
+    switch (id) {
+        case 'p': return PAWN;
+        case 'n': return KNIGHT;
+        case 'b': return BISHOP;
+        case 'u': return UNICORN;
+        case 'r': return ROOK;
+        case 'q': return QUEEN;
+        case 'k': return KING;
+        default: return EMPTY;
+    }
+}
@@ -14,62 +14,157 @@
 #include <cmath>
 
 // Constants
-const int INF = std::numeric_limits<int>::max();
 const int MAX_DEPTH_HARD = 12;             // Maximum search depth for hard mode
-const int MAX_QUIESCENCE_DEPTH = 8;        // Max depth for quiescence search
-const int NULL_MOVE_REDUCTION = 2;         // Reduction for null move pruning
-const int LATE_MOVE_REDUCTION = 1;         // Reduction for late move reduction
 const int RAZORING_DEPTH = 2;              // Depth to apply razoring
 const int RAZORING_MARGIN = 200;           // Margin for razoring
-const int LEVEL_CONTROL_WEIGHT = 10;       // Weight for level control
-const int SPACE_CONTROL_WEIGHT = 5;        // Weight for space control
-const int OUTPOST_BONUS = 20;              // Bonus for outposts
-const int PIECE_COORDINATION_BONUS = 15;   // Bonus for piece coordination
-const int THREAT_WEIGHT = 30;              // Weight for threat evaluation
-const int STABILITY_THRESHOLD = 50;        // Threshold for iterative deepening stability
 const int NULL_MOVE_MARGIN = 100;
+const int PAWN_STRUCTURE_WEIGHT = 5;       // Weight for pawn structure
 const long MAX_SEARCH_TIME = 1000; // Maximum search time in milliseconds
-
-// Enums
-enum EvaluationFlags {
-    EXACT,
-    LOWER_BOUND,
-    UPPER_BOUND
-};
-
-// Struct for Transposition Table Entry
-struct TTEntry {
-    u_int64_t key;
-    int depth;
-    int score;
-    int flag;
-    Turn bestMove;
-};
-
-// Initialize transposition table
-std::unordered_map<u_int64_t, TTEntry> Solver::transpositionTable;
+const int LIMIT_POLL_INTERVAL = 1024;      // Positions searched between two looks at the clock
+const int CAPTURE_ORDER_BONUS = 1 << 20;   // Puts every capture ahead of the quiet moves when ordering
+const int KILLER_ORDER_BONUS = 1 << 19;    // Then the killer moves of the ply
+const int COUNTER_ORDER_BONUS = 1 << 18;   // Then the move that refuted the opponent's last move
+const int HISTORY_MAX = 1 << 16;           // The history table is halved when an entry reaches this, staying below the bonuses
 
 // Setting up the mersenne twister random number generator for better random number generation
 std::random_device Solver::m_rd;
 std::mt19937 Solver::m_rng(Solver::m_rd());
 std::uniform_int_distribution<int> Solver::rng(0, INF);
 
-// Map each character to a specific integer weight (higher = more important)
-std::unordered_map<char, int> Solver::pieceWeight = {
-    {'b', 400}, {'k', 10000}, {'n', 400}, {'p', 100}, {'q', 900}, {'r', 500}, {'u', 400}
-};
+// Parameterized constructor
+Solver::Solver(int difficulty_) : Solver(difficulty_, TranspositionTable::DEFAULT_MEGABYTES) {}
 
-// Initialize piece-square table (example)
-int Solver::pieceSquareTable[BOARD_SIZE][BOARD_SIZE][BOARD_SIZE] = {
-    {{0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}},
-    {{5,  5,  5,  5,  5}, {5,  5,  5,  5,  5}, {5,  5,  5,  5,  5}, {5,  5,  5,  5,  5}, {5,  5,  5,  5,  5}},
-    {{1,  1,  2,  1,  1}, {1,  1,  2,  1,  1}, {1,  1,  2,  1,  1}, {1,  1,  2,  1,  1}, {1,  1,  2,  1,  1}},
-    {{0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}},
-    {{0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}, {0,  0,  0,  0,  0}}
-};
+Solver::Solver(int difficulty_, int hashMegabytes) : difficulty(difficulty_), moveLists(MAX_SEARCH_PLY), ply(0), nodes(0),
+    followPV(false), principalScore(0), analyzing(false), multiPV(1), threadCount(1), stopSearch(false), stopFlag(&stopSearch),
+    playedKey(0), ponderKey(0), ponderColor(0), pondering(false), ponderMove(NO_MOVE), ponderScore(0),
+    transpositionTable(std::make_shared<TranspositionTable>(hashMegabytes)) {
+    resetOrdering();
+}
 
-// Parameterized constructor
-Solver::Solver(int difficulty_) : difficulty(difficulty_) {}
+// A helper of owner, sharing its transposition table and stop flag
+Solver::Solver(Solver *owner) : difficulty(owner->difficulty), moveLists(MAX_SEARCH_PLY), ply(0), nodes(0),
+    followPV(false), principalScore(0), analyzing(false), multiPV(1), threadCount(1), stopSearch(false), stopFlag(&owner->stopSearch),
+    playedKey(0), ponderKey(0), ponderColor(0), pondering(false), ponderMove(NO_MOVE), ponderScore(0),
+    transpositionTable(owner->transpositionTable) {
+    resetOrdering();
+}
+
+void Solver::resetOrdering() {
+    clearKillers();
+    for (int from = 0; from < NUM_SQUARES; ++from) {
+        for (int to = 0; to < NUM_SQUARES; ++to) {
+            history[from][to] = 0;
+            counterMoves[from][to] = NO_MOVE;
+        }
+    }
+}
+
+// Killers are only worth trying in positions like those they refuted, so they do not outlive a search.
+// The history and countermove tables do: they keep ordering well from one move of the game to the next
+void Solver::clearKillers() {
+    for (int i = 0; i < MAX_SEARCH_PLY; ++i) {
+        killers[i][0] = killers[i][1] = NO_MOVE;
+    }
+}
+
+// Called when the quiet move "move" caused a beta cutoff at "depth"
+void Solver::updateOrdering(Board &board, MoveCode move, int depth) {
+    if (killers[ply][0] != move) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+    }
+
+    int &entry = history[moveFrom(move)][moveTo(move)];
+    entry += depth * depth;
+    if (entry >= HISTORY_MAX) {
+        // keep the proportions, but let new cutoffs count more than old ones
+        for (int from = 0; from < NUM_SQUARES; ++from) {
+            for (int to = 0; to < NUM_SQUARES; ++to) history[from][to] /= 2;
+        }
+    }
+
+    MoveCode lastMove = board.getLastMove();
+    if (lastMove != NO_MOVE) counterMoves[moveFrom(lastMove)][moveTo(lastMove)] = move;
+}
+
+// Called when move raised alpha at the current ply, after its search filled the row of the next ply
+void Solver::updatePrincipalVariation(MoveCode move) {
+    pvTable[ply][0] = move;
+    int length = 1;
+    if (ply + 1 < MAX_SEARCH_PLY) {
+        for (int i = 0; i < pvLength[ply + 1] && ply + 1 + i < MAX_SEARCH_PLY; ++i) {
+            pvTable[ply][length++] = pvTable[ply + 1][i];
+        }
+    }
+    pvLength[ply] = length;
+}
+
+// Called when a root move scored into the best multiPV moves, after updatePrincipalVariation() put its line in
+// the root row
+void Solver::addRootLine(int score) {
+    RootLine line;
+    line.score = score;
+    line.moves.assign(pvTable[0], pvTable[0] + pvLength[0]);
+    size_t i = 0;
+    while (i < rootLines.size() && rootLines[i].score >= score) ++i;
+    rootLines.insert(rootLines.begin() + i, line);
+    if ((int)rootLines.size() > multiPV) rootLines.pop_back();
+}
+
+Solver::~Solver() {
+    stopPonder();
+    stopHelpers();
+}
+
+void Solver::setThreads(int count) {
+    stopPonder();
+    stopHelpers();
+    threadCount = HAS_SEARCH_THREADS ? std::max(count, 1) : 1;
+#ifdef SEARCH_THREAD_POOL
+    threadCount = std::min(threadCount, SEARCH_THREAD_POOL);
+#endif
+    helpers.clear();
+    for (int i = 1; i < threadCount; ++i) {
+        helpers.emplace_back(new Solver(this));
+    }
+}
+
+int Solver::getThreads() const {
+    return threadCount;
+}
+
+double Solver::getNodes() const {
+    long long total = nodes;
+    for (const std::unique_ptr<Solver> &helper : helpers) total += helper->nodes;
+    return (double)total;
+}
+
+void Solver::startHelpers(Board &board) {
+    stopSearch = false;
+    for (size_t i = 0; i < helpers.size(); ++i) {
+        // each thread gets its own copy of the board; half of them start a ply deeper, so the threads drift apart
+        helperThreads.emplace_back(&Solver::helperSearch, helpers[i].get(), board, 1 + int(i % 2));
+    }
+}
+
+void Solver::stopHelpers() {
+    stopSearch = true;
+    for (std::thread &thread : helperThreads) thread.join();
+    helperThreads.clear();
+}
+
+void Solver::helperSearch(Board board, int firstDepth) {
+    ply = 0;
+    nodes = 0;
+    clearKillers();
+    principalVariation.clear();
+    int scores[2] = {INF, INF}; // of the last iterations of each parity
+    for (int depth = firstDepth; depth < MAX_SEARCH_PLY - MAX_QUIESCENCE_DEPTH && !stopFlag->load(std::memory_order_relaxed); ++depth) {
+        MoveCode bestMove;
+        scores[depth % 2] = aspirationSearch(board, depth, scores[depth % 2], bestMove);
+        principalVariation.assign(pvTable[0], pvTable[0] + pvLength[0]);
+    }
+}
 
 // Utility function to generate a random integer in the range [low, high] inclusive
 int Solver::randRange(int low, int high){
@@ -85,29 +180,89 @@ int Solver::distance(Coordinate coord){
 }
 
 // Helper function to evaluate the usefulness of a piece on the board
-int Solver::pieceScore(Piece *piece){
+int Solver::pieceScore(PieceCode piece, Coordinate location){
     // A piece's score is defined as their weight + their distance to the center
-    // If the piece is dead ignore it
-    if(!piece->getIsAlive()) return 0;
+    // If the square is empty ignore it
+    if(piece == EMPTY) return 0;
     // If the piece is a king then it should stay away from the middle
-    if(piece->getId() == 'k'){
-        return (pieceWeight[piece->getId()] - distance(piece->getLocation())) * piece->getColor();
+    int type = pieceTypeOf(piece);
+    if(type == KING){
+        return (PIECE_VALUES[type] - distance(location)) * pieceColorOf(piece);
+    }
+    return (PIECE_VALUES[type] + distance(location)) * pieceColorOf(piece);
+}
+
+// The change in score when move is played (before it is played), including the piece taken and any promotion
+int Solver::scoreChange(Board &board, MoveCode move){
+    Coordinate from = Coordinate::fromSquare(moveFrom(move)), to = Coordinate::fromSquare(moveTo(move));
+    PieceCode piece = board.squares[moveFrom(move)];
+    int change = pieceScore(piece, to) - pieceScore(piece, from) - pieceScore(board.squares[moveTo(move)], to);
+    if (movePromotion(move) != EMPTY) {
+        change += pieceScore(makePieceCode(movePromotion(move), pieceColorOf(piece)), to) - pieceScore(piece, to);
+    }
+    return change;
+}
+
+// The material won by move itself: the piece taken, plus the promotion
+int Solver::materialGain(Board &board, MoveCode move){
+    int gain = PIECE_VALUES[pieceTypeOf(board.squares[moveTo(move)])];
+    if (movePromotion(move) != EMPTY) {
+        gain += PIECE_VALUES[movePromotion(move)] - PIECE_VALUES[PAWN];
+    }
+    return gain;
+}
+
+/* Static exchange evaluation: the material move wins (negative if it loses) once both sides have taken back on its
+* square for as long as it pays, each time with their least valuable attacker. Pieces are taken off a copy of the
+* occupancy as they are exchanged, uncovering the sliders behind them along any of the 13 line axes.
+* Pins and checks are ignored.
+*/
+int Solver::staticExchange(Board &board, MoveCode move){
+    int from = moveFrom(move), to = moveTo(move);
+    int side = pieceColorOf(board.squares[from]);
+    int onSquare = movePromotion(move) != EMPTY ? movePromotion(move) : pieceTypeOf(board.squares[from]); // type of the piece to be taken next
+    int gain[MAX_EXCHANGES]; // gain[i]: what the side making capture i wins if the exchange stops right after it
+    gain[0] = materialGain(board, move);
+
+    Bitboard occupied = board.getOccupied();
+    Bitboard attackers = board.getAttackers(to);
+    int captures = 0;
+    while (captures + 1 < MAX_EXCHANGES) {
+        // the piece that just took has left its square
+        occupied &= ~squareBit(from);
+        attackers = (attackers | board.getXRayAttacker(to, from, occupied)) & occupied;
+        side = -side;
+
+        Bitboard candidates = attackers & board.getPieces(side);
+        if (!candidates) break;
+        int type = PAWN;
+        while (!(candidates & board.getPieces(side, type))) ++type;
+        from = lsb(candidates & board.getPieces(side, type));
+
+        ++captures;
+        gain[captures] = PIECE_VALUES[onSquare] - gain[captures - 1];
+        onSquare = type;
+    }
+
+    // Going back, each side only takes if that does better than stopping
+    for (; captures > 0; --captures) {
+        gain[captures - 1] = -std::max(-gain[captures - 1], gain[captures]);
     }
-    return (pieceWeight[piece->getId()] + distance(piece->getLocation())) * piece->getColor();
+    return gain[0];
 }
 
 // Utility function to determine whether a pawn can be promoted
-bool Solver::canPromote(Piece* piece){
-    return piece->getId() == 'p' &&
-           ((piece->getColor() == WHITE && piece->getLocation().row + piece->getLocation().lvl == 8) ||
-            (piece->getColor() == BLACK && piece->getLocation().row + piece->getLocation().lvl == 0));
+bool Solver::canPromote(PieceCode piece, Coordinate location){
+    return pieceTypeOf(piece) == PAWN &&
+           ((pieceColorOf(piece) == WHITE && location.row + location.lvl == 8) ||
+            (pieceColorOf(piece) == BLACK && location.row + location.lvl == 0));
 }
 
-int Solver::mobilityScore(Board &board, Piece *piece) {
-    if (!piece->getIsAlive()) return 0;
-    int mobility = piece->getMoves(board, false).size();
+int Solver::mobilityScore(Board &board, Coordinate location) {
+    if (!board.isOnBoard(location) || board.isVacant(location)) return 0;
+    int mobility = popCount(board.getMoveTargets(location.toSquare(), board.getPieceCode(location)));
     // Increase mobility score for pieces in the center levels
-    mobility += (3 - abs(piece->getLocation().lvl - 2));
+    mobility += (3 - abs(location.lvl - 2));
     return mobility;
 }
 
@@ -117,204 +272,96 @@ int Solver::kingSafetyScore(Board &board, int color) {
     // Penalize if the king is in the center or near open files/diagonals
     score -= (abs(kingLocation.row - 2) + abs(kingLocation.col - 2) + abs(kingLocation.lvl - 2));
 
-    // Add a bonus for having pawns nearby
-    for (int lvl = std::max(0, kingLocation.lvl - 1); lvl <= std::min(BOARD_SIZE - 1, kingLocation.lvl + 1); ++lvl) {
-        for (int row = std::max(0, kingLocation.row - 1); row <= std::min(BOARD_SIZE - 1, kingLocation.row + 1); ++row) {
-            for (int col = std::max(0, kingLocation.col - 1); col <= std::min(BOARD_SIZE - 1, kingLocation.col + 1); ++col) {
-                Piece* piece = board.getPieceAt(row, col, lvl);
-                if (piece->getId() == 'p' && piece->getColor() == color) {
-                    score += 20; // Bonus for each nearby pawn
-                }
-            }
-        }
-    }
+    // Add a bonus for each pawn on a neighbouring square
+    if (!board.isOnBoard(kingLocation)) return score;
+    score += 20 * popCount(KING_ATTACKS[kingLocation.toSquare()] & board.getPieces(color, PAWN));
     return score;
 }
 
 int Solver::evaluateLevelControl(Board &board, int color) {
     int score = 0;
-    for (int lvl = 0; lvl < BOARD_SIZE; ++lvl) {
-        int levelScore = 0;
-        for (int row = 0; row < BOARD_SIZE; ++row) {
-            for (int col = 0; col < BOARD_SIZE; ++col) {
-                Piece* piece = board.getPieceAt(row, col, lvl);
-                if (piece->getColor() == color) {
-                    levelScore++;
-                } else if (piece->getColor() == -color) {
-                    levelScore--;
-                }
-            }
+    // own pieces count for the color, enemy pieces against it
+    for (int side : {color, -color}) {
+        Bitboard pieces = board.getPieces(side);
+        while (pieces) {
+            int lvl = Coordinate::fromSquare(popLsb(pieces)).lvl;
+            score += side * color * (lvl == 2 ? 2 : 1); // Prioritize the center level
         }
-        score += levelScore * (lvl == 2 ? 2 : 1); // Prioritize the center level
     }
     return score * LEVEL_CONTROL_WEIGHT;
 }
 
 int Solver::evaluateSpaceControl(Board &board, int color) {
     int score = 0;
-    for (int row = 0; row < BOARD_SIZE; ++row) {
-        for (int col = 0; col < BOARD_SIZE; ++col) {
-            for (int lvl = 0; lvl < BOARD_SIZE; ++lvl) {
-                Piece* piece = board.getPieceAt(row, col, lvl);
-                if (piece->getColor() == color) {
-                    //Count how many empty locations the color has
-                    for (Move m : piece->getMoves(board, false)) {
-                        Coordinate target = piece->getLocation() + m;
-                        if(target.row >= 0 && target.row < BOARD_SIZE &&
-                           target.col >= 0 && target.col < BOARD_SIZE &&
-                           target.lvl >= 0 && target.lvl < BOARD_SIZE &&
-                           board.getPieceAt(target)->getId() == ' ') {
-                            score++;
-                        }
-                    }
-                }
-            }
-        }
+    Bitboard pieces = board.getPieces(color);
+    while (pieces) {
+        //Count how many empty locations the color has
+        int square = popLsb(pieces);
+        score += popCount(board.getMoveTargets(square, board.getPieceCode(Coordinate::fromSquare(square))) & ~board.getOccupied());
     }
     return score * SPACE_CONTROL_WEIGHT;
 }
 
 int Solver::evaluateOutposts(Board &board, int color) {
     int score = 0;
-    for (int lvl = 0; lvl < BOARD_SIZE; ++lvl) {
-        for (int row = 0; row < BOARD_SIZE; ++row) {
-            for (int col = 0; col < BOARD_SIZE; ++col) {
-                Piece* piece = board.getPieceAt(row, col, lvl);
-                if (piece->getColor() == color && piece->getId() != 'p') {
-                    if (isOutpost(board, {row, col, lvl}, color)) {
-                        score += OUTPOST_BONUS;
-                    }
-                }
-            }
+    Bitboard pieces = board.getPieces(color) & ~board.getPieces(color, PAWN);
+    while (pieces) {
+        if (isOutpost(board, Coordinate::fromSquare(popLsb(pieces)), color)) {
+            score += OUTPOST_BONUS;
         }
     }
     return score;
 }
 
 bool Solver::isOutpost(Board &board, Coordinate coord, int color) {
-    // Check if the piece is protected by a pawn
-    bool protectedByPawn = false;
-    for (int dr = -1; dr <= 1; ++dr) {
-        for (int dc = -1; dc <= 1; ++dc) {
-            for (int dl = -1; dl <= 1; ++dl) {
-                if (abs(dr) + abs(dc) + abs(dl) != 1) continue;
-                int newRow = coord.row + dr;
-                int newCol = coord.col + dc;
-                int newLvl = coord.lvl + dl;
-                if (newRow >= 0 && newRow < BOARD_SIZE && newCol >= 0 && newCol < BOARD_SIZE && newLvl >= 0 && newLvl < BOARD_SIZE) {
-                    Piece* supportingPiece = board.getPieceAt(newRow, newCol, newLvl);
-                    if (supportingPiece->getId() == 'p' && supportingPiece->getColor() == color) {
-                        protectedByPawn = true;
-                        break;
-                    }
-                }
-            }
-            if (protectedByPawn) break;
-        }
-        if (protectedByPawn) break;
-    }
-    if (!protectedByPawn) return false;
-
-    // Check if the piece is difficult to attack (no enemy pawns can attack it)
-    for (int dr = -1; dr <= 1; ++dr) {
-        for (int dc = -1; dc <= 1; ++dc) {
-            for (int dl = -1; dl <= 1; ++dl) {
-                if (abs(dr) + abs(dc) + abs(dl) != 1) continue;
-                int newRow = coord.row + dr;
-                int newCol = coord.col + dc;
-                int newLvl = coord.lvl + dl;
-                 if (newRow >= 0 && newRow < BOARD_SIZE && newCol >= 0 && newCol < BOARD_SIZE && newLvl >= 0 && newLvl < BOARD_SIZE) {
-                    Piece* attackingPiece = board.getPieceAt(newRow, newCol, newLvl);
-                    if (attackingPiece->getId() == 'p' && attackingPiece->getColor() == -color) {
-                        return false;
-                    }
-                }
-            }
-        }
-    }
-    return true;
+    Bitboard attackers = board.getAttackers(coord.toSquare());
+    // The piece must be protected by a pawn, and difficult to attack (no enemy pawns can attack it)
+    return (attackers & board.getPieces(color, PAWN)) && !(attackers & board.getPieces(-color, PAWN));
 }
 
 int Solver::evaluatePieceCoordination(Board &board, int color) {
     int score = 0;
-    for (int lvl = 0; lvl < BOARD_SIZE; ++lvl) {
-        for (int row = 0; row < BOARD_SIZE; ++row) {
-            for (int col = 0; col < BOARD_SIZE; ++col) {
-                Piece* piece = board.getPieceAt(row, col, lvl);
-                if (piece->getColor() == color) {
-                    score += countSupportingPieces(board, {row, col, lvl}, color);
-                }
-            }
-        }
+    Bitboard pieces = board.getPieces(color);
+    while (pieces) {
+        score += countSupportingPieces(board, Coordinate::fromSquare(popLsb(pieces)), color);
     }
     return score * PIECE_COORDINATION_BONUS;
 }
 
 int Solver::evaluateThreats(Board &board, int color) {
-   int score = 0;
-    for (int row = 0; row < BOARD_SIZE; ++row) {
-        for (int col = 0; col < BOARD_SIZE; ++col) {
-            for (int lvl = 0; lvl < BOARD_SIZE; ++lvl) {
-                Piece* piece = board.getPieceAt(row, col, lvl);
-                if(piece->getColor() == color) {
-                   auto moves = piece->getMoves(board, true);
-                    for (Move move : moves) {
-                        Coordinate newLoc = piece->getLocation() + move;
-                        Piece* target = board.getPieceAt(newLoc);
-                        if (target->getColor() == -color && target->getId() != 'k'){
-                            score += pieceWeight[target->getId()]; //Value of threatened piece
-
-                        }
-
-                    }
-                }
-            }
-        }
+    int score = 0;
+    // every attack on an enemy piece other than the king counts
+    Bitboard targets = board.getPieces(-color) & ~board.getPieces(-color, KING);
+    while (targets) {
+        int target = popLsb(targets);
+        int attackers = popCount(board.getAttackers(target) & board.getPieces(color));
+        score += attackers * PIECE_VALUES[pieceTypeOf(board.squares[target])]; //Value of threatened piece
     }
     return score * THREAT_WEIGHT;
 }
 
 int Solver::evaluate3DSpaceControl(Board &board, int color) {
     int score = 0;
-    for (int lvl = 0; lvl < BOARD_SIZE; ++lvl) {
-        for (int row = 0; row < BOARD_SIZE; ++row) {
-            for (int col = 0; col < BOARD_SIZE; ++col) {
-                Piece* piece = board.getPieceAt(row, col, lvl);
-                if (piece->getColor() == color) {
-                    score += piece->getMoves(board, false).size() * (3 - abs(lvl - 2));
-                }
-            }
-        }
+    Bitboard pieces = board.getPieces(color);
+    while (pieces) {
+        int square = popLsb(pieces);
+        int lvl = Coordinate::fromSquare(square).lvl;
+        score += popCount(board.getMoveTargets(square, board.squares[square])) * (3 - abs(lvl - 2));
     }
     return score * SPACE_CONTROL_WEIGHT;
 }
 
 int Solver::countSupportingPieces(Board &board, Coordinate coord, int color) {
-    int count = 0;
-    for (int lvl = std::max(0, coord.lvl - 1); lvl <= std::min(BOARD_SIZE - 1, coord.lvl + 1); ++lvl) {
-        for (int row = std::max(0, coord.row - 1); row <= std::min(BOARD_SIZE - 1, coord.row + 1); ++row) {
-            for (int col = std::max(0, coord.col - 1); col <= std::min(BOARD_SIZE - 1, coord.col + 1); ++col) {
-                if ((row != coord.row || col != coord.col || lvl != coord.lvl) && board.getPieceAt(row, col, lvl)->getColor() == color) {
-                    count++;
-                }
-            }
-        }
-    }
-    return count;
+    // friendly pieces on the 26 neighbouring squares
+    return popCount(KING_ATTACKS[coord.toSquare()] & board.getPieces(color));
 }
 
 int Solver::evaluate3DPawnColumn(Board &board, int col, int lvl, int color) {
     int score = 0;
-    int pawnCount = 0;
-    bool hasOpenSpace = false;
-    for (int row = 0; row < BOARD_SIZE; ++row) {
-        Piece* piece = board.getPieceAt(row, col, lvl);
-        if (piece->getId() == 'p' && piece->getColor() == color) {
-            pawnCount++;
-        } else if (piece->getId() == ' ') {
-            hasOpenSpace = true;
-        }
-    }
+    // the squares of all rows at this column and level
+    Bitboard column = lineSquares(ROOK_AXES + 2, Coordinate(0, col, lvl).toSquare());
+    int pawnCount = popCount(column & board.getPieces(color, PAWN));
+    bool hasOpenSpace = (column & ~board.getOccupied()) != 0;
     if (pawnCount > 1) score -= 10; // Penalize doubled pawns
     if (hasOpenSpace) score += 5; // Reward open columns
     return score;
@@ -322,46 +369,15 @@ int Solver::evaluate3DPawnColumn(Board &board, int col, int lvl, int color) {
 
 int Solver::evaluate3DMaterialBalance(Board &board, int color) {
     int materialScore = 0;
-    for (int lvl = 0; lvl < BOARD_SIZE; ++lvl) {
-        for (int row = 0; row < BOARD_SIZE; ++row) {
-            for (int col = 0; col < BOARD_SIZE; ++col) {
-                Piece* piece = board.getPieceAt(row, col, lvl);
-                if (piece->getColor() == color) {
-                    materialScore += pieceWeight[piece->getId()];
-                } else if (piece->getColor() == -color) {
-                    materialScore -= pieceWeight[piece->getId()];
-                }
-            }
+    for (int side : {color, -color}) {
+        Bitboard pieces = board.getPieces(side);
+        while (pieces) {
+            materialScore += side * color * PIECE_VALUES[pieceTypeOf(board.squares[popLsb(pieces)])];
         }
     }
     return materialScore;
 }
 
-void Solver::updatePieceSquareTable(Board &board) {
-    for (int lvl = 0; lvl < BOARD_SIZE; ++lvl) {
-        for (int row = 0; row < BOARD_SIZE; ++row) {
-            for (int col = 0; col < BOARD_SIZE; ++col) {
-                pieceSquareTable[row][col][lvl] = calculateSquareValue(board, {row, col, lvl});
-            }
-        }
-    }
-}
-
-int Solver::calculateSquareValue(Board &board, Coordinate coord) {
-    int value = 0;
-    // Example: Increase value if the square controls important areas
-    for (int lvl = std::max(0, coord.lvl - 1); lvl <= std::min(BOARD_SIZE - 1, coord.lvl + 1); ++lvl) {
-        for (int row = std::max(0, coord.row - 1); row <= std::min(BOARD_SIZE - 1, coord.row + 1); ++row) {
-            for (int col = std::max(0, coord.col - 1); col <= std::min(BOARD_SIZE - 1, coord.col + 1); ++col) {
-                if (board.getPieceAt(row, col, lvl)->getId() == ' ') {
-                    value++; // More control over empty squares
-                }
-            }
-        }
-    }
-    return value;
-}
-
 int Solver::evaluate3DPawnStructure(Board &board, int color) {
     int score = 0;
     for (int lvl = 0; lvl < BOARD_SIZE; ++lvl) {
@@ -379,114 +395,138 @@ bool Solver::shouldApplyNullMove(Board &board, int color, int depth) {
     return evaluate3DMaterialBalance(board, color) > NULL_MOVE_MARGIN;
 }
 
-int Solver::razoring(Board &board, int alpha, int depth, int color) {
-    if (depth <= RAZORING_DEPTH) {
-        int score = evaluate(board) + RAZORING_MARGIN;
-        if (score <= alpha) {
-            return quiescenceSearch(board, alpha - RAZORING_MARGIN, alpha, color, MAX_QUIESCENCE_DEPTH, score);
-        }
-    }
-    return alpha;
-}
-
-Turn Solver::iterativeDeepening(Board &board, int maxDepth, int color) {
-    Turn bestMove;
-    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+// Searches one ply deeper at a time until a limit is reached. An iteration cut short by the limits is thrown away,
+// so the result is always that of the last completed one
+int Solver::iterativeDeepening(Board &board, int maxDepth, MoveCode &bestMove) {
+    int bestScore = 0;
+    int olderScore = INF; // score of the iteration before the last one, INF until there is one
+    bestMove = NO_MOVE;
+    principalVariation.clear();
     for (int depth = 1; depth <= maxDepth; ++depth) {
-        Turn currentBest = solve(board, depth, -INF, INF, color, evaluate(board));
-        if (depth > 1 && abs(currentBest.score - bestMove.score) > STABILITY_THRESHOLD) {
+        MoveCode currentMove;
+        int currentScore = aspirationSearch(board, depth, olderScore, currentMove);
+        if (stopSearch) {
             break;
         }
-        bestMove = currentBest;
+        olderScore = depth == 1 ? INF : bestScore;
+        bestScore = currentScore;
+        bestMove = currentMove;
+        principalVariation.assign(pvTable[0], pvTable[0] + pvLength[0]);
 
-        if (shouldStopSearch(startTime)) {
+        if (!pondering.load(std::memory_order_relaxed) && shouldStopSearch(searchStart)) {
             break;
         }
     }
-    return bestMove;
-}
-
-bool Solver::shouldStopSearch(std::chrono::steady_clock::time_point startTime) {
-    auto currentTime = std::chrono::steady_clock::now();
-    auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - startTime).count();
-    return elapsedTime > MAX_SEARCH_TIME;
-}
-
-Turn Solver::probeTranspositionTable(u_int64_t key, int depth, int alpha, int beta) {
-    if (transpositionTable.find(key) != transpositionTable.end()) {
-        TTEntry entry = transpositionTable[key];
-        if (entry.depth >= depth) {
-            if (entry.flag == EXACT) return entry.bestMove;
-            if (entry.flag == LOWER_BOUND && entry.score >= beta) return entry.bestMove;
-            if (entry.flag == UPPER_BOUND && entry.score <= alpha) return entry.bestMove;
+    if (bestMove == NO_MOVE) {
+        // not even the first iteration completed: fall back on the move ordered first
+        MoveList &moves = moveLists[0];
+        moves.clear();
+        genMoves(board, moves);
+        if (!moves.empty()) {
+            bestMove = moves[0];
+            bestScore = evaluate(board) * board.getSideToMove();
+            principalVariation.assign(1, bestMove);
+        }
+    }
+    return bestScore;
+}
+
+// Searches the root in a window around previousScore (INF for the full window), since the score seldom moves far
+// from one iteration to the next and a narrow window cuts off more. When the score falls out of the window, the
+// window is widened on that side and the root searched again.
+// The score an iteration finds depends on which side moves last, so the window is set around the score two
+// iterations back, which is much closer than the last one
+int Solver::aspirationSearch(Board &board, int depth, int previousScore, MoveCode &bestMove) {
+    int window = ASPIRATION_WINDOW;
+    int alpha = -INF, beta = INF;
+    if (abs(previousScore) < INF - MAX_SEARCH_PLY) {
+        // (mate scores change by a ply at a time, and get the full window)
+        alpha = previousScore - window;
+        beta = previousScore + window;
+    }
+    while (true) {
+        followPV = true;
+        int score = solve(board, depth, alpha, beta, evaluate(board), bestMove);
+        if (stopFlag->load(std::memory_order_relaxed)) return score;
+        if (score > alpha && score < beta) return score;
+
+        window *= 4;
+        bool open = window > MAX_ASPIRATION_WINDOW;
+        if (score <= alpha) {
+            if (alpha == -INF) return score;
+            alpha = open ? -INF : previousScore - window;
+        } else {
+            if (beta == INF) return score;
+            beta = open ? INF : previousScore + window;
         }
     }
-    return Turn(); // Return invalid move if not found
 }
 
-int Solver::pvSearch(Board &board, int depth, int alpha, int beta, int color, bool isPV) {
-    if (depth == 0) return quiescenceSearch(board, alpha, beta, color, MAX_QUIESCENCE_DEPTH, evaluate(board));
-
-    // Check transposition table
-    u_int64_t boardKey = board.getBoardKey();
-    Turn ttMove = probeTranspositionTable(boardKey, depth, alpha, beta);
-
-    if (ttMove.currentLocation.row != -1) {
-        // Use TT move
+// Stops the search (and its helpers) once the node budget or the time of the current nextMove() call runs out.
+// Only the main solver polls, counting its own positions, so a node budget gives the same move with any thread count
+void Solver::checkLimits() {
+    if (stopFlag != &stopSearch || pondering.load(std::memory_order_relaxed)) return;
+    if (limits.maxNodes > 0 && nodes >= limits.maxNodes) {
+        stopSearch = true;
+    } else if (limits.maxTime > 0 && nodes % LIMIT_POLL_INTERVAL == 0) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - searchStart).count();
+        if (elapsed >= limits.maxTime) stopSearch = true;
     }
+}
 
-    std::vector<Turn> moves = genMoves(board, color);
-
-    for (Turn& move : moves) {
-        // Make move
-
-        int score;
-        if (isPV) {
-            // Principal Variation Search
-            score = -pvSearch(board, depth - 1, -beta, -alpha, -color, true);
-        } else {
-            // Zero Window Search
-            score = -pvSearch(board, depth - 1, -alpha - 1, -alpha, -color, false);
-            if (score > alpha && score < beta) {
-                // If ZWS fails high, do a full PVS
-                score = -pvSearch(board, depth - 1, -beta, -alpha, -color, true);
-            }
-        }
-
-        // Undo move
+bool Solver::shouldStopSearch(std::chrono::steady_clock::time_point startTime) {
+    if (limits.maxTime <= 0) return false;
+    auto currentTime = std::chrono::steady_clock::now();
+    auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - startTime).count();
+    return elapsedTime > limits.maxTime;
+}
+
+// Returns true if the stored result settles the position (setting score). bestMove is set to the stored best move
+// whenever the position is found, to be searched first
+bool Solver::probeTranspositionTable(u_int64_t key, int depth, int alpha, int beta, int &score, MoveCode &bestMove) {
+    TTEntry entry;
+    bestMove = NO_MOVE;
+    if (!transpositionTable->probe(key, entry)) return false;
+    bestMove = entry.bestMove;
+    if (entry.depth < depth) return false;
+    int stored = scoreFromTable(entry.score);
+    if (entry.flag == EXACT || (entry.flag == LOWER_BOUND && stored >= beta) || (entry.flag == UPPER_BOUND && stored <= alpha)) {
+        score = stored;
+        return true;
+    }
+    return false;
+}
+
+// A mate score is -INF plus the ply the side to move is mated at, counted from the root (INF minus it for the winner).
+// The table counts those plies from the position stored, which may be reached at another ply, or in a later search
+int Solver::scoreToTable(int score) const {
+    if (score > INF - MAX_SEARCH_PLY) return score + ply;
+    if (score < -INF + MAX_SEARCH_PLY) return score - ply;
+    return score;
+}
 
-        alpha = std::max(alpha, score);
-        if (alpha >= beta) break;
-    }
-    return alpha;
+int Solver::scoreFromTable(int score) const {
+    if (score > INF - MAX_SEARCH_PLY) return score - ply;
+    if (score < -INF + MAX_SEARCH_PLY) return score + ply;
+    return score;
 }
 
 int Solver::materialScore(Board &board) {
     int score = 0;
-    for (int lvl = 0; lvl < BOARD_SIZE; ++lvl) {
-        for (int row = 0; row < BOARD_SIZE; ++row) {
-            for (int col = 0; col < BOARD_SIZE; ++col) {
-                Piece* piece = board.getPieceAt(row, col, lvl);
-                if (piece->getId() != ' ') {
-                    score += pieceScore(piece);
-                }
-            }
-        }
+    Bitboard pieces = board.getOccupied();
+    while (pieces) {
+        int square = popLsb(pieces);
+        score += pieceScore(board.squares[square], Coordinate::fromSquare(square));
     }
     return score;
 }
 
 int Solver::positionalScore(Board &board) {
     int score = 0;
-    for (int lvl = 0; lvl < BOARD_SIZE; ++lvl) {
-        for (int row = 0; row < BOARD_SIZE; ++row) {
-            for (int col = 0; col < BOARD_SIZE; ++col) {
-                Piece* piece = board.getPieceAt(row, col, lvl);
-                if (piece->getId() != ' ') {
-                    score += pieceSquareTable[row][col][lvl];
-                }
-            }
-        }
+    Bitboard pieces = board.getOccupied();
+    while (pieces) {
+        Coordinate c = Coordinate::fromSquare(popLsb(pieces));
+        score += PIECE_SQUARE_TABLE[c.row][c.col][c.lvl];
     }
     return score;
 }
@@ -496,7 +536,7 @@ int Solver::evaluate(Board &board){
     int score = 0;
     score += materialScore(board);
     score += positionalScore(board);
-    score += mobilityScore(board, board.getKing(WHITE)) - mobilityScore(board, board.getKing(BLACK));
+    score += mobilityScore(board, board.getKingLocation(WHITE)) - mobilityScore(board, board.getKingLocation(BLACK));
     score += kingSafetyScore(board, WHITE) - kingSafetyScore(board, BLACK);
     score += evaluateLevelControl(board, WHITE) - evaluateLevelControl(board, BLACK);
     score += evaluateSpaceControl(board, WHITE) - evaluateSpaceControl(board, BLACK);
@@ -509,339 +549,402 @@ int Solver::evaluate(Board &board){
     return score;
 }
 
-// Utility function to determine all the possible moves the current color can play
-std::vector<Turn> Solver::genMoves(Board &board, int color){
-    std::vector<Turn> moves;
-    for(int i = 0; i < BOARD_SIZE; ++i) {
-        for(int j = 0; j < BOARD_SIZE; ++j) {
-            for(int k = 0; k < BOARD_SIZE; ++k) {
-                // Must be piece of the same color and must be alive
-                if(board.board[i][j][k]->getColor() == color && board.board[i][j][k]->getIsAlive()){
-                    // Go through all the moves, make sure you don't leave your king checked
-                    for (Move m : board.board[i][j][k]->getMoves(board, false)) {
-                        Piece* oldPiece = board.board[i + m.row][j + m.col][k + m.lvl];
-                        int newScore = -pieceScore(board.board[i][j][k]) - pieceScore(oldPiece);
-                        board.updateLocation({i, j, k}, m);
-                        if(!board.isChecked(color)) {
-                            // Valid move
-                            moves.push_back(Turn(newScore + pieceScore(board.board[i + m.row][j + m.col][k + m.lvl]), Coordinate(i, j, k), m));
-                        }
-                        // Undo the move on the board
-                        board.updateLocation({i + m.row, j + m.col, k + m.lvl}, -m);
-                        if (oldPiece->getId() != ' ') {
-                            board.board[i + m.row][j + m.col][k + m.lvl] = oldPiece;
-                            oldPiece->setIsAlive(true);
-                        }
-                    }
-                }
-            }
+// Utility function to determine all the possible moves the side to move can play, best first
+void Solver::genMoves(Board &board, MoveList &moves){
+    int color = board.getSideToMove();
+    board.generateLegalMoves(color, moves);
+    MoveCode lastMove = board.getLastMove();
+    MoveCode counterMove = lastMove == NO_MOVE ? NO_MOVE : counterMoves[moveFrom(lastMove)][moveTo(lastMove)];
+    for (int i = 0; i < moves.size(); ++i) {
+        MoveCode move = moves[i];
+        PieceCode victim = board.squares[moveTo(move)];
+        if (victim != EMPTY || movePromotion(move) != EMPTY) {
+            // 1. Prioritize captures (most valuable victim first, then least valuable attacker); a promotion counts
+            // as capturing the piece the pawn becomes
+            int gained = victim != EMPTY ? pieceTypeOf(victim) : movePromotion(move);
+            moves.setScore(i, CAPTURE_ORDER_BONUS + MVV_LVA[gained][pieceTypeOf(board.squares[moveFrom(move)])]);
+        } else if (move == killers[ply][0] || move == killers[ply][1]) {
+            // 2. Then the quiet moves that caused cutoffs at this ply before, the most recent first
+            moves.setScore(i, KILLER_ORDER_BONUS + (move == killers[ply][0]));
+        } else if (move == counterMove) {
+            // 3. Then the usual answer to the opponent's last move
+            moves.setScore(i, COUNTER_ORDER_BONUS);
+        } else {
+            // 4. Then by how often the move caused cutoffs anywhere, breaking ties by how much it improves the
+            // piece's position (higher score for white, lower for black)
+            moves.setScore(i, history[moveFrom(move)][moveTo(move)] + scoreChange(board, move) * color);
         }
     }
- if(color == WHITE){
-       sort(moves.begin(), moves.end(), [&](const Turn &lhs, const Turn &rhs){
-          // 1. Prioritize captures (highest score if capturing a valuable piece)
-          Coordinate newLocLhs = lhs.currentLocation + lhs.change;
-          Coordinate newLocRhs = rhs.currentLocation + rhs.change;
-
-          int lhsCaptureScore = Solver::pieceWeight[board.getPieceAt(newLocLhs)->getId()];
-          int rhsCaptureScore = Solver::pieceWeight[board.getPieceAt(newLocRhs)->getId()];
-
-          if(lhsCaptureScore > 0 || rhsCaptureScore > 0){
-            return lhsCaptureScore > rhsCaptureScore;
-          }
-
-          // 2. Then prioritize moves that improve piece position (higher score)
-          return lhs.score > rhs.score;
-        });
-    } else {
-        sort(moves.begin(), moves.end(), [&](const Turn &lhs, const Turn &rhs){
-          Coordinate newLocLhs = lhs.currentLocation + lhs.change;
-          Coordinate newLocRhs = rhs.currentLocation + rhs.change;
-
-          int lhsCaptureScore = Solver::pieceWeight[board.getPieceAt(newLocLhs)->getId()];
-          int rhsCaptureScore = Solver::pieceWeight[board.getPieceAt(newLocRhs)->getId()];
-
-          if(lhsCaptureScore > 0 || rhsCaptureScore > 0){
-            return lhsCaptureScore < rhsCaptureScore;
-          }
-          return lhs.score < rhs.score;
-        });
-    }
-    return moves;
+    moves.sortByScore();
 }
 
 bool Solver::isEndgame(Board &board) {
     // Simple check for the endgame:  few pieces remaining
-    int pieceCount = 0;
-    for (int row = 0; row < BOARD_SIZE; ++row) {
-        for (int col = 0; col < BOARD_SIZE; ++col) {
-            for (int lvl = 0; lvl < BOARD_SIZE; ++lvl) {
-                if (board.getPieceAt(row, col, lvl)->getId() != ' ' && board.getPieceAt(row, col, lvl)->getId() != 'k') {
-                    pieceCount++;
-                }
-            }
-        }
-    }
+    int pieceCount = popCount(board.getOccupied() & ~board.typePieces[KING]);
     return pieceCount <= 8;  //Adjust this threshold
 }
 
-int Solver::quiescenceSearch(Board &board, int ALPHA, int BETA, int color, int depth, int score) {
+// Scores are from the point of view of the side to move (negamax); "score" is the running evaluation, white's point of view
+int Solver::quiescenceSearch(Board &board, int ALPHA, int BETA, int depth, int score) {
+    ++nodes;
+    checkLimits();
+    if (stopFlag->load(std::memory_order_relaxed)) return 0; // out of time or nodes; the result is thrown away
+
     // Stand pat (assume no further captures are good)
-    int standPat = score;
-    if (color == WHITE) {
-        if (standPat >= BETA)
-            return BETA;
-        ALPHA = std::max(ALPHA, standPat);
-    } else {
-        if (standPat <= ALPHA)
-            return ALPHA;
-        BETA = std::min(BETA, standPat);
-    }
+    int standPat = score * board.getSideToMove();
+    if (standPat >= BETA)
+        return BETA;
+    ALPHA = std::max(ALPHA, standPat);
 
-    if (depth == 0) return standPat;
+    if (depth == 0) return ALPHA;
 
-    // Generate only capture moves
-    std::vector<Turn> captureMoves;
-    for (Turn move : genMoves(board, color)) {
-        Coordinate newLoc = move.currentLocation + move.change;
-        if (board.getPieceAt(newLoc)->getId() != ' ') {
-            captureMoves.push_back(move);
-        }
-    }
+    // Only captures (and promotions) that do not lose material are searched
+    MovePicker picker(*this, board, moveLists[ply]);
+    for (MoveCode move = picker.next(); move != NO_MOVE; move = picker.next()) {
+        // Delta pruning: skip the captures that cannot lift the score up to alpha, even with a positional bonus
+        if (standPat + materialGain(board, move) + DELTA_MARGIN <= ALPHA) continue;
 
-    for (Turn curMove : captureMoves) {
-        // Move new piece
-        Coordinate newLoc = curMove.currentLocation + curMove.change;
-        Piece* pawn, * oldPiece = board.getPieceAt(newLoc);
-
-        // Update score as well
-        int newScore = score + curMove.score;
-        board.updateLocation(curMove.currentLocation, curMove.change);
-        bool promoted = canPromote(board.getPieceAt(newLoc));
-        if (promoted) {
-            // If the pawn can promote, then change the piece to a queen (the best option)
-            pawn = board.getPieceAt(newLoc);
-            // Update scores again
-            newScore -= pieceScore(board.getPieceAt(newLoc));
-            ((Pawn*)pawn)->promote(board, new Queen(newLoc.row, newLoc.col, newLoc.lvl, color), false);
-            newScore += pieceScore(board.getPieceAt(newLoc));
-        }
+        // Update score as well, then play the move
+        int newScore = score + scoreChange(board, move);
+        board.makeMove(move);
+        ++ply;
 
-        int eval = quiescenceSearch(board, ALPHA, BETA, -color, depth - 1, newScore);
+        int eval = -quiescenceSearch(board, -BETA, -ALPHA, depth - 1, newScore);
 
         // Revert the move
-        if (promoted) {
-            // Delete the pointer if the pawn was promoted
-            delete board.board[newLoc.row][newLoc.col][newLoc.lvl];
-            board.board[newLoc.row][newLoc.col][newLoc.lvl] = pawn;
-        }
+        --ply;
+        board.unmakeMove();
 
-        board.updateLocation(newLoc, -curMove.change);
-        if (oldPiece->getId() != ' ') {
-            board.board[newLoc.row][newLoc.col][newLoc.lvl] = oldPiece;
-            oldPiece->setIsAlive(true);
-        }
-
-        if (color == WHITE) {
-            ALPHA = std::max(ALPHA, eval);
-            if (ALPHA >= BETA)
-                return BETA;
-        } else {
-            BETA = std::min(BETA, eval);
-            if (BETA <= ALPHA)
-                return ALPHA;
-        }
+        if (eval >= BETA)
+            return BETA;
+        ALPHA = std::max(ALPHA, eval);
     }
-    if (color == WHITE) return ALPHA;
-    return BETA;
+    return ALPHA;
 }
 
-Turn Solver::solve(Board &board, int depth, int ALPHA, int BETA, int color, int score){
+// Negamax: scores are from the point of view of the side to move, and mates closer to the root score higher
+int Solver::solve(Board &board, int depth, int ALPHA, int BETA, int score, MoveCode &bestMove){
+    bestMove = NO_MOVE;
+    pvLength[ply] = 0;
+    int color = board.getSideToMove();
+    bool root = ply == 0;
+    ++nodes;
+    checkLimits();
+    if (stopFlag->load(std::memory_order_relaxed)) return 0; // out of time or nodes; the result is thrown away
 
-    // First look for checkmates, then stalemates
-    if(board.isChecked(color)){
-        if(board.isCheckmated(color)){
-            // White Mate --> -INF, Black Mate --> INF
-            return Turn(INF * -color, Coordinate(-2, -1, -1), Move(0, 0, 0));
+    // A repeated position is a draw
+    if (!root && board.isRepetition()) {
+        return 0;
+    }
+
+    bool inCheck = board.isChecked(color);
+    if(depth <= 0){
+        // At the horizon only look for checkmates (there are few evasions to try), then evaluate the board
+        if (inCheck && board.isCheckmated(color)) {
+            return -INF + ply;
         }
-    } else if(board.isStalemated(color)){
-        // Nobody wins
-        return Turn(0, Coordinate(-1, -1, -1), Move(0, 0, 0));
+        return quiescenceSearch(board, ALPHA, BETA, MAX_QUIESCENCE_DEPTH, score);
     }
 
-    if(depth == 0){
-        // Evaluate board
-        return Turn(quiescenceSearch(board, ALPHA, BETA, color, MAX_QUIESCENCE_DEPTH, score), Coordinate(-4, -1, -1), Move(0, 0, 0));
+    // Transposition Table Lookup
+    u_int64_t boardKey = board.getBoardKey();
+    int ttScore;
+    MoveCode ttMove;
+    if (probeTranspositionTable(boardKey, depth, ALPHA, BETA, ttScore, ttMove) && !root) {
+        bestMove = ttMove;
+        return ttScore;
+    }
+
+    // On the line of the previous iteration, its move goes first
+    MoveCode pvMove = NO_MOVE;
+    if (followPV) {
+        if (ply < (int)principalVariation.size()) {
+            pvMove = principalVariation[ply];
+        } else {
+            followPV = false;
+        }
     }
 
-// Null Move Pruning (disabled in endgame)
-    if (depth > 2 && !isEndgame(board)) {
+    if (!root && !inCheck) {
+        // Null Move Pruning: if passing still keeps the opponent at bay, a real move will too
         if (shouldApplyNullMove(board, color, depth)) {
-            // Temporarily "pass" the turn
-            Board tempBoard = board;  // Create a copy of the board
-            int nullMoveScore = evaluate(tempBoard);  // Evaluate the board after the null move
-            int score = -solve(tempBoard, depth - 1 - NULL_MOVE_REDUCTION, -BETA, -ALPHA, -color, nullMoveScore).score;
-
-            if (score >= BETA) {
-                return Turn(BETA, Coordinate(-5, -1, -1), Move(0, 0, 0));  // Prune
+            MoveCode reply;
+            bool onPV = followPV;
+            followPV = false;
+            board.makeNullMove();
+            ++ply;
+            int nullScore = -solve(board, depth - 1 - NULL_MOVE_REDUCTION, -BETA, -BETA + 1, score, reply);
+            --ply;
+            board.unmakeNullMove();
+            followPV = onPV;
+
+            if (nullScore >= BETA) {
+                return BETA;  // Prune
             }
         }
-    }
 
-    // Razoring
-    if (depth <= RAZORING_DEPTH) {
-        int score = evaluate(board) + RAZORING_MARGIN;
-        if (score <= ALPHA) {
-            int qs = quiescenceSearch(board, ALPHA - RAZORING_MARGIN, BETA, color, MAX_QUIESCENCE_DEPTH, score);
-            return Turn(qs, Coordinate(-6, -1, -1), Move(0, 0, 0));
+        // Razoring: close to the horizon, a position far below alpha only gets a quiescence search
+        if (depth <= RAZORING_DEPTH && evaluate(board) * color + RAZORING_MARGIN <= ALPHA) {
+            int qs = quiescenceSearch(board, ALPHA, ALPHA + 1, MAX_QUIESCENCE_DEPTH, score);
+            if (qs <= ALPHA) return qs;
         }
     }
 
-    // Transposition Table Lookup
-    u_int64_t boardKey = board.getBoardKey();
-    Turn ttMove = probeTranspositionTable(boardKey, depth, ALPHA, BETA);
-    if (ttMove.currentLocation.row != -1) {
-        return ttMove;
-    }
-
-    // Identify the best move on the board
-    Turn best(color == WHITE ? -INF : INF, Coordinate(-3, -1, -1), Move(0, 0, 0));
-    std::vector<Turn> moves = genMoves(board, color);
+    // Identify the best move on the board, trying the moves in the order of the picker
+    int originalAlpha = ALPHA;
+    int bestScore = -INF;
+    MovePicker picker(*this, board, moveLists[ply], pvMove != NO_MOVE ? pvMove : ttMove, ply);
+    bool multiLines = root && analyzing;
+    if (multiLines) rootLines.clear();
 
     // Principal Variation Search
-    bool isPV = true;
-    for (size_t i = 0; i < moves.size(); ++i) {
-        Turn& curMove = moves[i];
-
-        // Move new piece
-        Coordinate newLoc = curMove.currentLocation + curMove.change;
-        Piece* pawn, * oldPiece = board.getPieceAt(newLoc);
-
-        // Update score as well
-        int newScore = score + curMove.score;
-        board.updateLocation(curMove.currentLocation, curMove.change);
-        bool promoted = canPromote(board.getPieceAt(newLoc));
-        if (promoted) {
-            // If the pawn can promote, then change the piece to a queen (the best option)
-            pawn = board.getPieceAt(newLoc);
-            // Update scores again
-            newScore -= pieceScore(board.getPieceAt(newLoc));
-            ((Pawn*)pawn)->promote(board, new Queen(newLoc.row, newLoc.col, newLoc.lvl, color), false);
-            newScore += pieceScore(board.getPieceAt(newLoc));
-        }
+    int moveCount = 0;
+    for (MoveCode move = picker.next(); move != NO_MOVE; move = picker.next()) {
+        ++moveCount;
+        bool quiet = board.squares[moveTo(move)] == EMPTY && movePromotion(move) == EMPTY;
+        // only the first move keeps to the previous line
+        followPV = followPV && move == pvMove;
+
+        // Update score as well, then play the move
+        int newScore = score + scoreChange(board, move);
+        board.makeMove(move);
+        ++ply;
 
         // Late Move Reduction
         int reduction = 0;
-        if (i > 4 && depth > 2) {  // Apply LMR to later moves at higher depths
+        if (moveCount > 5 && depth > 2) {  // Apply LMR to later moves at higher depths
             reduction = LATE_MOVE_REDUCTION;
         }
 
         // Recurse to the other opponent
+        MoveCode reply;
         int eval;
-        if (isPV) {
-            eval = -solve(board, depth - 1 - reduction, -BETA, -ALPHA, -color, newScore).score;
-            isPV = false;
+        if (moveCount == 1 || (multiLines && (int)rootLines.size() < multiPV)) {
+            // (in Multi-PV, every move is searched in full until there are enough lines)
+            eval = -solve(board, depth - 1, -BETA, -ALPHA, newScore, reply);
         } else {
-            eval = -solve(board, depth - 1 - reduction, -ALPHA - 1, -ALPHA, -color, newScore).score;
+            eval = -solve(board, depth - 1 - reduction, -ALPHA - 1, -ALPHA, newScore, reply);
+            if (eval > ALPHA && reduction > 0) {
+                // the reduced search was too pessimistic about this move
+                eval = -solve(board, depth - 1, -ALPHA - 1, -ALPHA, newScore, reply);
+            }
             if (eval > ALPHA && eval < BETA) {
-                eval = -solve(board, depth - 1 - reduction, -BETA, -ALPHA, -color, newScore).score;
+                eval = -solve(board, depth - 1, -BETA, -ALPHA, newScore, reply);
             }
         }
 
         // Undo the move
-        if (promoted) {
-            // Delete the pointer if the pawn was promoted
-            delete board.board[newLoc.row][newLoc.col][newLoc.lvl];
-            board.board[newLoc.row][newLoc.col][newLoc.lvl] = pawn;
+        --ply;
+        board.unmakeMove();
+        followPV = false;
+
+        if (eval > bestScore) {
+            bestMove = move;
+            bestScore = eval;
         }
-        board.updateLocation(newLoc, -curMove.change);
-        if (oldPiece->getId() != ' ') {
-            board.board[newLoc.row][newLoc.col][newLoc.lvl] = oldPiece;
-            oldPiece->setIsAlive(true);
+        if (eval > ALPHA && !stopFlag->load(std::memory_order_relaxed)) {
+            updatePrincipalVariation(move);
+            if (multiLines) addRootLine(eval);
         }
-
-        if (color == WHITE) {
-            if (eval > best.score) {
-                best = curMove;
-                best.score = eval;
-            }
-            ALPHA = std::max(ALPHA, eval);
-            if (ALPHA >= BETA) {
-                break;  // Beta cutoff
-            }
+        if (multiLines) {
+            // once there are enough lines, a move has to beat the last of them to become one
+            ALPHA = (int)rootLines.size() < multiPV ? originalAlpha : std::max(originalAlpha, rootLines.back().score);
         } else {
-            if (eval < best.score) {
-                best = curMove;
-                best.score = eval;
-            }
-            BETA = std::min(BETA, eval);
-            if (BETA <= ALPHA) {
-                break;  // Alpha cutoff
-            }
+            ALPHA = std::max(ALPHA, eval);
+        }
+        if (ALPHA >= BETA) {
+            if (quiet && !stopFlag->load(std::memory_order_relaxed)) updateOrdering(board, move, depth);
+            break;  // Beta cutoff
         }
     }
 
-    // Store the result in the transposition table
-    TTEntry newEntry;
-    newEntry.key = boardKey;
-    newEntry.depth = depth;
-    newEntry.score = best.score;
-    newEntry.bestMove = best;
+    // No legal move: checkmate, or stalemate where nobody wins
+    if (moveCount == 0) {
+        return inCheck ? -INF + ply : 0;
+    }
 
-    if (best.score <= ALPHA) {
-        newEntry.flag = UPPER_BOUND;
-    } else if (best.score >= BETA) {
-        newEntry.flag = LOWER_BOUND;
-    } else {
-        newEntry.flag = EXACT;
+    // Store the result in the transposition table, unless the search was stopped halfway
+    if (stopFlag->load(std::memory_order_relaxed)) return 0;
+    int flag = EXACT;
+    if (bestScore <= originalAlpha) {
+        flag = UPPER_BOUND;
+    } else if (bestScore >= BETA) {
+        flag = LOWER_BOUND;
     }
-    transpositionTable[boardKey] = newEntry;
+    transpositionTable->store(boardKey, depth, scoreToTable(bestScore), flag, bestMove);
 
-    return best;
+    return bestScore;
 }
 
-Turn Solver::solve(Board &board, int color) {
-    if (difficulty == HARD_MODE) {
-        return iterativeDeepening(board, MAX_DEPTH_HARD, color);
-    }
-    int depth = 3;
-    if (difficulty == MEDIUM) depth = 2;
-    return solve(board, depth, -INF, INF, color, evaluate(board));
-}              int eval = -solve(board, depth - 1 - reduction, -BETA, -ALPHA, -color, newScore).score;
+// Converts an engine move for the frontend. With no move to play, the turn's location is (-1, -1, -1)
+static Turn toTurn(MoveCode move, int score) {
+    if (move == NO_MOVE) return Turn(score, Coordinate(-1, -1, -1), Move(0, 0, 0));
+    Coordinate from = Coordinate::fromSquare(moveFrom(move));
+    return Turn(score, from, Coordinate::fromSquare(moveTo(move)) - from);
+}
 
-        // Undo the move
-        if(promoted){
-            // Delete the pointer if the pawn was promoted
-            delete board.board[newLoc.row][newLoc.col][newLoc.lvl];
-            board.board[newLoc.row][newLoc.col][newLoc.lvl] = pawn;
-        }
-        board.updateLocation(newLoc, -curMove.change);
-        if (oldPiece->getId() != ' ') {
-            board.board[newLoc.row][newLoc.col][newLoc.lvl] = oldPiece;
-            oldPiece->setIsAlive(true);
-        }
+SearchLimits Solver::getDefaultLimits() const {
+    SearchLimits defaults;
+    defaults.maxTime = MAX_SEARCH_TIME;
+    defaults.maxNodes = 0;
+    defaults.maxDepth = difficulty == HARD_MODE ? MAX_DEPTH_HARD : (difficulty == MEDIUM ? 2 : 3);
+    return defaults;
+}
 
-        if(color == WHITE){
-            if(eval > best.score){
-                best = curMove;
-                best.score = eval;
-            }
-            ALPHA = std::max(ALPHA, eval);
-            if(ALPHA >= BETA){
-                break; // Beta cutoff
-            }
-        } else {
-            if(eval < best.score){
-                best = curMove;
-                best.score = eval;
-            }
-            BETA = std::min(BETA, eval);
-            if(BETA <= ALPHA){
-                break; // Alpha cutoff
-            }
-        }
+Turn Solver::nextMove(Board &board, int color) {
+    return nextMoveWithLimits(board, color, getDefaultLimits());
+}
+
+// Sets up a search of nextMoveWithLimits() or analyze(), and starts the helpers
+void Solver::startSearch(Board &board, int color, SearchLimits searchLimits) {
+    // the frontend passes the side to move along; the board tracks it as well
+    board.setSideToMove(color);
+    transpositionTable->newSearch();
+    limits = searchLimits;
+    if (limits.maxDepth <= 0 || limits.maxDepth > MAX_SEARCH_PLY - MAX_QUIESCENCE_DEPTH - 1) {
+        limits.maxDepth = MAX_SEARCH_PLY - MAX_QUIESCENCE_DEPTH - 1;
     }
-    return best;
+    searchStart = std::chrono::steady_clock::now();
+    ply = 0;
+    nodes = 0;
+    clearKillers();
+    startHelpers(board);
 }
 
+Turn Solver::nextMoveWithLimits(Board &board, int color, SearchLimits searchLimits) {
+    stopPonder();
+    startSearch(board, color, searchLimits);
+    MoveCode bestMove;
+    int score = iterativeDeepening(board, limits.maxDepth, bestMove);
+    stopHelpers();
+    // the turn's score is from white's point of view
+    principalScore = score * color;
+    playedLine = principalVariation;
+    if (bestMove != NO_MOVE) {
+        board.makeMove(bestMove);
+        playedKey = board.getBoardKey();
+        board.unmakeMove();
+    }
+    return toTurn(bestMove, principalScore);
+}
+
+bool Solver::startPonder(Board &board, int color) {
+    stopPonder();
+    if (!HAS_SEARCH_THREADS || playedLine.size() < 2) return false;
+    // the board must be the one the last search expected, with its move played
+    board.setSideToMove(color);
+    if (board.getBoardKey() != playedKey || !board.isLegalMove(playedLine[1])) return false;
+
+    Board ponderBoard = board;
+    ponderBoard.makeMove(playedLine[1]);
+    ponderKey = ponderBoard.getBoardKey();
+    ponderColor = -color;
+    ponderMove = NO_MOVE;
+    pondering = true;
+    startSearch(ponderBoard, ponderColor, getDefaultLimits());
+    ponderThread = std::thread(&Solver::ponderSearch, this, ponderBoard, ponderColor);
+    return true;
+}
 
+void Solver::ponderSearch(Board board, int color) {
+    MoveCode bestMove;
+    int score = iterativeDeepening(board, limits.maxDepth, bestMove);
+    stopHelpers();
+    ponderMove = bestMove;
+    ponderScore = score * color;
+}
+
+Turn Solver::ponderhit(Board &board, int color) {
+    if (!ponderThread.joinable() || board.getBoardKey() != ponderKey || color != ponderColor) {
+        // the opponent played another move
+        return nextMove(board, color);
+    }
+    // The limits apply from now on, the time being counted from the start of the ponder search: the time the
+    // opponent took to move is time this solver did not have to wait
+    pondering = false;
+    ponderThread.join();
+    if (ponderMove == NO_MOVE) return nextMove(board, color);
+
+    board.setSideToMove(color);
+    board.makeMove(ponderMove);
+    playedKey = board.getBoardKey();
+    board.unmakeMove();
+    principalScore = ponderScore;
+    playedLine = principalVariation;
+    return toTurn(ponderMove, principalScore);
+}
+
+void Solver::stopPonder() {
+    if (!ponderThread.joinable()) return;
+    stopSearch = true;
+    ponderThread.join();
+    pondering = false;
+}
+
+vector<Turn> Solver::getPrincipalVariation() const {
+    vector<Turn> line;
+    for (MoveCode move : playedLine) {
+        line.push_back(toTurn(move, principalScore));
+    }
+    return line;
+}
+
+/* The root is searched once per iteration, as in nextMove(), but keeps the best "lines" moves: while there are
+* fewer, every move is searched with the full window, and after that a move only has to beat the last of them.
+* The deeper positions are searched as usual and share the transposition table, so this costs far less than a
+* search per line.
+*/
+vector<vector<Turn>> Solver::analyze(Board &board, int color, SearchLimits searchLimits, int lines) {
+    stopPonder();
+    startSearch(board, color, searchLimits);
+    MoveList rootMoves;
+    board.generateLegalMoves(color, rootMoves);
+    multiPV = std::max(1, std::min(lines, rootMoves.size()));
+    analyzing = true;
+
+    // An iteration cut short by the limits is thrown away
+    vector<RootLine> found;
+    rootLines.clear();
+    principalVariation.clear();
+    for (int depth = 1; depth <= limits.maxDepth && !rootMoves.empty(); ++depth) {
+        MoveCode bestMove;
+        followPV = true;
+        solve(board, depth, -INF, INF, evaluate(board), bestMove);
+        if (stopSearch || rootLines.empty()) break;
+        found = rootLines;
+        principalVariation = found[0].moves;
+
+        if (shouldStopSearch(searchStart)) break;
+    }
+    stopHelpers();
+
+    if (found.empty()) {
+        // not even the first iteration completed: fall back on the moves ordered first
+        MoveList &moves = moveLists[0];
+        moves.clear();
+        genMoves(board, moves);
+        for (int i = 0; i < multiPV && i < moves.size(); ++i) {
+            RootLine line;
+            line.score = evaluate(board) * color;
+            line.moves.assign(1, moves[i]);
+            found.push_back(line);
+        }
+    }
+    analyzing = false;
+    multiPV = 1;
+
+    vector<vector<Turn>> result;
+    for (const RootLine &line : found) {
+        vector<Turn> turns;
+        for (MoveCode move : line.moves) {
+            // scores are from white's point of view
+            turns.push_back(toTurn(move, line.score * color));
+        }
+        result.push_back(turns);
+    }
+    if (!found.empty()) {
+        playedLine = found[0].moves;
+        principalScore = found[0].score * color;
+    }
+    return result;
+}
@@ -0,0 +1,107 @@
+#include "../include/transposition.h"
+
+static_assert(sizeof(TTSlot) == 16 && sizeof(TTBucket) == 64, "a bucket fills one cache line");
+
+const int GENERATION_MASK = 63; // generations are stored in 6 bits
+
+// Layout of a slot's data word: score in bits 0-31, best move in bits 32-47, depth + 1 in bits 48-55
+// (0 marks an empty slot), flag in bits 56-57 and generation in bits 58-63
+static u_int64_t packEntry(int depth, int score, int flag, MoveCode bestMove, int generation) {
+    return (u_int64_t)(unsigned int)score | (u_int64_t)bestMove << 32 | (u_int64_t)(depth + 1) << 48 |
+           (u_int64_t)flag << 56 | (u_int64_t)generation << 58;
+}
+
+static TTEntry unpackEntry(u_int64_t key, u_int64_t data) {
+    TTEntry entry;
+    entry.key = key;
+    entry.score = (int)(unsigned int)data;
+    entry.bestMove = MoveCode(data >> 32);
+    entry.depth = int((data >> 48) & 0xFF) - 1;
+    entry.flag = int((data >> 56) & 3);
+    entry.generation = int(data >> 58);
+    return entry;
+}
+
+TranspositionTable::TranspositionTable(int megabytes) {
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(int megabytes) {
+    size_t count = 1;
+    while (count * 2 * sizeof(TTBucket) <= (size_t)max(megabytes, 1) * 1024 * 1024) count *= 2;
+    // swapping with a new vector gives the old memory back, which resize() would not
+    vector<TTBucket>(count).swap(buckets);
+    mask = count - 1;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (TTBucket& bucket : buckets) {
+        for (TTSlot& slot : bucket.slots) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed); // depth -1: shallower than any search, so filled first
+        }
+    }
+    generation = 0;
+}
+
+void TranspositionTable::newSearch() {
+    generation = (generation + 1) & GENERATION_MASK;
+}
+
+bool TranspositionTable::probe(u_int64_t key, TTEntry& entry) const {
+    const TTBucket& bucket = buckets[key & mask];
+    for (const TTSlot& slot : bucket.slots) {
+        u_int64_t data = slot.data.load(std::memory_order_relaxed);
+        if (data != 0 && (slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+            entry = unpackEntry(key, data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(u_int64_t key, int depth, int score, int flag, MoveCode bestMove) {
+    TTBucket& bucket = buckets[key & mask];
+
+    // A position already in the bucket is overwritten where it is
+    TTSlot* target = nullptr;
+    for (TTSlot& slot : bucket.slots) {
+        u_int64_t data = slot.data.load(std::memory_order_relaxed);
+        if (data != 0 && (slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+            target = &slot;
+            // keep the best move of an earlier search if this one did not find any
+            if (bestMove == NO_MOVE) bestMove = unpackEntry(key, data).bestMove;
+            break;
+        }
+    }
+
+    if (target == nullptr) {
+        // Otherwise the depth-preferred slot least worth keeping is replaced: each search of age counts as
+        // two plies of depth lost, so results of earlier nextMove() calls give way first
+        int lowestWorth = 0, victimDepth = 0, victimGeneration = 0;
+        for (int i = 0; i < BUCKET_SIZE - 1; ++i) {
+            TTEntry entry = unpackEntry(0, bucket.slots[i].data.load(std::memory_order_relaxed));
+            int age = (generation - entry.generation) & GENERATION_MASK;
+            int worth = entry.depth - 2 * age;
+            if (target == nullptr || worth < lowestWorth) {
+                target = &bucket.slots[i];
+                lowestWorth = worth;
+                victimDepth = entry.depth;
+                victimGeneration = entry.generation;
+            }
+        }
+        // unless the new result is shallower, in which case it goes to the always-replace slot
+        if (victimGeneration == generation && victimDepth > depth) {
+            target = &bucket.slots[BUCKET_SIZE - 1];
+        }
+    }
+
+    u_int64_t data = packEntry(depth, score, flag, bestMove, generation);
+    target->check.store(key ^ data, std::memory_order_relaxed);
+    target->data.store(data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::getMegabytes() const {
+    return (int)(buckets.size() * sizeof(TTBucket) / (1024 * 1024));
+}
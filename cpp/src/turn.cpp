@@ -1,5 +1,11 @@
 #include "../include/turn.h"
 
+Turn::Turn() {
+    // an invalid turn, recognisable by its negative row
+    score = 0;
+    currentLocation = Coordinate(-1, -1, -1);
+}
+
 Turn::Turn(int score_, Coordinate currentLocation_, Move change_){
     score = score_;
     currentLocation = currentLocation_;
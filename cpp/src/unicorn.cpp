@@ -4,18 +4,6 @@ char Unicorn::getId() {
     return 'u';
 }
 
-vector<Move> Unicorn::directions = {
-    Move(1, 1, 1),
-    Move(-1, 1, 1),
-    Move(1, -1, 1),
-    Move(1, 1, -1),
-    Move(1, -1, -1),
-    Move(-1, 1, -1),
-    Move(-1, -1, 1),
-    Move(-1, -1, -1)
-};
-
-vector<Move> Unicorn::getMoves(Board board, bool prune) {
-    // get all moves in line based of piece directions
-    return getAllMovesInLine(directions, board, prune);
-}
\ No newline at end of file
+vector<Move> Unicorn::getMoves(Board& board, bool prune) {
+    return board.getMovesAt(location, prune);
+}
@@ -0,0 +1,29 @@
+#include "../include/zobrist.h"
+
+// splitmix64: a fixed seed gives the same keys in every build
+constexpr u_int64_t nextRandom(u_int64_t& state) {
+    u_int64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr std::array<std::array<u_int64_t, NUM_SQUARES>, 2 * KING + 1> buildPieceKeys() {
+    std::array<std::array<u_int64_t, NUM_SQUARES>, 2 * KING + 1> keys{};
+    u_int64_t state = 0x3D3D3D3D;
+    for (int code = -KING; code <= KING; ++code) {
+        if (code == EMPTY) continue; // an empty square does not change the key
+        for (int square = 0; square < NUM_SQUARES; ++square) {
+            keys[code + KING][square] = nextRandom(state);
+        }
+    }
+    return keys;
+}
+
+constexpr u_int64_t buildBlackToMoveKey() {
+    u_int64_t state = 0x5A5A5A5A;
+    return nextRandom(state);
+}
+
+constexpr std::array<std::array<u_int64_t, NUM_SQUARES>, 2 * KING + 1> ZOBRIST_PIECES = buildPieceKeys();
+constexpr u_int64_t ZOBRIST_BLACK_TO_MOVE = buildBlackToMoveKey();
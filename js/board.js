@@ -109,8 +109,18 @@ class Board {
     }
 
     // returns a the piece object located at a specific coordinate
+    // (the piece belongs to the cpp board, so it must not be deleted)
     getPiece(row, col, lvl) {
-        return this.cppBoard.getBoard().get(row).get(col).get(lvl);
+        return this.cppBoard.getPieceAt(row, col, lvl);
+    }
+
+    // plays a move on the cpp board, freeing the temporary cpp objects afterwards
+    updateCppBoard(pRow, pCol, pLvl, mRow, mCol, mLvl) {
+        var coordinate = new Module.Coordinate(pRow, pCol, pLvl);
+        var move = new Module.Move(mRow, mCol, mLvl);
+        this.cppBoard.updateLocation(coordinate, move);
+        coordinate.delete();
+        move.delete();
     }
 
     // returns the div located at a specific coordinate
@@ -385,7 +395,9 @@ class Board {
         var moves = piece.getMoves(this.cppBoard, true);
 
         for (var i = 0; i < moves.size(); i++) {
-            var m = moves.get(i);
+            var move = moves.get(i);
+            var m = { row: move.row, col: move.col, lvl: move.lvl };
+            move.delete();
             var nRow = row + m.row;
             var nCol = col + m.col;
             var nLvl = lvl + m.lvl;
@@ -396,6 +408,7 @@ class Board {
             legalTint.dataset["move"] = [m.row, m.col, m.lvl];
             legalTint.dataset["pieceName"] = pieceName;
         }
+        moves.delete();
     }
 
     // determines if a piece can promote given its name and row
@@ -467,10 +480,7 @@ class Board {
             .map((x) => parseInt(x));
 
         // update the cpp board to match the state of the GUI board
-        this.cppBoard.updateLocation(
-            new Module.Coordinate(pRow, pCol, pLvl),
-            new Module.Move(mRow, mCol, mLvl)
-        );
+        this.updateCppBoard(pRow, pCol, pLvl, mRow, mCol, mLvl);
 
         const [nRow, nCol, nLvl] = [pRow + mRow, pCol + mCol, pLvl + mLvl];
 
@@ -519,17 +529,24 @@ class Board {
     }
 
     getNextComputerMove() {
-        // compute and parse next move to play
-        var nxTurn = this.opponent.nextMove(this.cppBoard, this.turn);
+        // compute and parse next move to play (carrying on from the search made while the player was thinking, if
+        // they played the move it expected)
+        var nxTurn = this.opponent.ponderhit(this.cppBoard, this.turn);
+        // each property read copies a cpp object, which has to be freed
+        var location = nxTurn.currentLocation;
+        var change = nxTurn.change;
 
         // current location
-        const pRow = nxTurn.currentLocation.row;
-        const pCol = nxTurn.currentLocation.col;
-        const pLvl = nxTurn.currentLocation.lvl;
+        const pRow = location.row;
+        const pCol = location.col;
+        const pLvl = location.lvl;
         // change in movement
-        const mRow = nxTurn.change.row;
-        const mCol = nxTurn.change.col;
-        const mLvl = nxTurn.change.lvl;
+        const mRow = change.row;
+        const mCol = change.col;
+        const mLvl = change.lvl;
+        location.delete();
+        change.delete();
+        nxTurn.delete();
 
         // Do not continue updating the board if the game has already ended
         if (pRow < 0) {
@@ -537,10 +554,7 @@ class Board {
         }
 
         // update the cpp board to match the state of the GUI board
-        this.cppBoard.updateLocation(
-            new Module.Coordinate(pRow, pCol, pLvl),
-            new Module.Move(mRow, mCol, mLvl)
-        );
+        this.updateCppBoard(pRow, pCol, pLvl, mRow, mCol, mLvl);
         const [nRow, nCol, nLvl] = [pRow + mRow, pCol + mCol, pLvl + mLvl];
 
         var cppPiece = this.getPiece(nRow, nCol, nLvl);
@@ -588,6 +602,10 @@ class Board {
         }
         this.turn = this.turn === 1 ? -1 : 1;
         this.changeClickability(this.turn == 1, this.turn == -1);
+
+        // keep searching while the player thinks, in the position after the reply the computer expects
+        // (does nothing when the engine is built without threads)
+        if (!this.gameOver) this.opponent.startPonder(this.cppBoard, this.turn);
     }
 
     // color = l -> white, color = d -> black